@@ -15,6 +15,9 @@ int main(int, char**)
 
     FAIO::init(pathMPQ);
 
+    if (settings.get<std::string>("Cache", "enabled") == "true")
+        FAIO::initDiskCache(settings.get<std::string>("Cache", "directory"), settings.get<uint64_t>("Cache", "maxSizeMB") * 1024 * 1024);
+
     DiabloExe::DiabloExe exe(pathEXE);
     std::cout << exe.dump();
 
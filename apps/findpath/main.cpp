@@ -1,211 +1,216 @@
-#include "../../freeablo/apps/freeablo/faworld/findpath.h"
-#include "../../freeablo/apps/freeablo/faworld/gamelevel.h"
 #include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
-#include <map>
-#include <misc/stdhashes.h>
-#include <queue>
-#include <set>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <string>
 #include <vector>
 
-using namespace std::chrono;
-using namespace std;
+#include <boost/program_options.hpp>
 
-namespace FAWorld
-{
-    class LevelImpl : public GameLevelImpl
-    {
+#include <misc/allocationcounter.h>
+#include <misc/timinghistogram.h>
 
-    public:
-        static const int MAP_SIZE = 20;
+#include "../freeablo/falevelgen/levelgen.h"
+#include "../freeablo/falevelgen/random.h"
+#include "../freeablo/faworld/findpath.h"
+#include "../freeablo/faworld/gamelevel.h"
 
-        LevelImpl()
-        {
-            generateMap();
-            // drawMap();
-        }
+///
+/// Times pathfinding on generated level layouts, the same size as the game's, without needing any game data.
+/// The start and goal pairs all come from --seed, so runs with the same options do the same searches. Every search is run once
+/// before timing starts, so what's measured is the steady state, with the search arrays already grown.
+///
 
-        int32_t width() const { return MAP_SIZE; }
+namespace bpo = boost::program_options;
 
-        int32_t height() const { return MAP_SIZE; }
+typedef std::pair<int32_t, int32_t> Location;
 
-        bool isPassable(int x, int y) const { return gameMap[y][x] == 0 ? true : false; }
+class LayoutLevel : public FAWorld::GameLevelImpl
+{
+public:
+    LayoutLevel(int32_t width, int32_t height, std::vector<uint8_t> passable) : mWidth(width), mHeight(height), mPassable(std::move(passable)) {}
 
-    private:
-        int gameMap[MAP_SIZE][MAP_SIZE];
+    int32_t width() const { return mWidth; }
+    int32_t height() const { return mHeight; }
 
-    private:
-        void generateMap()
-        {
-            memset(gameMap, 0, MAP_SIZE * MAP_SIZE * sizeof(int));
-            for (int i = 0; i < MAP_SIZE; i++)
-            {
-                gameMap[0][i] = 1;
-                gameMap[MAP_SIZE - 1][i] = 1;
-            }
-
-            gameMap[MAP_SIZE / 2][MAP_SIZE / 2] = 1;
-            gameMap[MAP_SIZE / 2 + 1][MAP_SIZE / 2] = 1;
-            gameMap[MAP_SIZE / 2 + 2][MAP_SIZE / 2] = 1;
-            gameMap[MAP_SIZE / 2 + 3][MAP_SIZE / 2] = 1;
-            gameMap[MAP_SIZE / 2 + 4][MAP_SIZE / 2] = 1;
-
-            for (int i = 3; i <= MAP_SIZE - 1; i++)
-                for (int j = 14; j <= 16; j++)
-                    if (i == MAP_SIZE - 3)
-                        gameMap[i][j] = 0;
-                    else
-                        gameMap[i][j] = 1;
-        }
+    bool isPassable(int x, int y) const { return x >= 0 && x < mWidth && y >= 0 && y < mHeight && mPassable[x + y * mWidth]; }
+
+private:
+    int32_t mWidth;
+    int32_t mHeight;
+    std::vector<uint8_t> mPassable;
+};
+
+static bool parseOptions(int argc, char** argv, bpo::variables_map& variables)
+{
+    bpo::options_description desc("Options");
+    desc.add_options()("help,h", "Print help")("seed,s", bpo::value<int32_t>()->default_value(1), "Seed for the level layout and the searches")(
+        "level,l", bpo::value<int32_t>()->default_value(1), "Dungeon level to generate the layout for (1-16)")(
+        "searches,n", bpo::value<int32_t>()->default_value(1000), "Number of different start and goal pairs")(
+        "rounds,r", bpo::value<int32_t>()->default_value(20), "Times to run through all of the searches")(
+        "range", bpo::value<int32_t>()->default_value(25), "Furthest a goal can be from its start, in tiles along each axis")(
+        "adjacent,a", "Stop next to the goal, like a monster walking up to attack")(
+        "algorithm", bpo::value<std::string>()->default_value("astar"), "astar or jps (jump point search)")(
+        "draw,d", "Print the layout with the first search's path on it");
+
+    try
+    {
+        bpo::store(bpo::parse_command_line(argc, argv, desc), variables);
 
-        void drawMap()
+        if (variables.count("help"))
         {
-            for (int y = 0; y < MAP_SIZE; y++)
-            {
-                for (int x = 0; x < MAP_SIZE; x++)
-                {
-                    if (gameMap[y][x])
-                        cout << "# ";
-                    else
-                        cout << ". ";
-                }
-
-                cout << endl;
-            }
+            std::cout << desc << std::endl;
+            return false;
         }
-    };
-}
 
-using namespace FAWorld;
+        bpo::notify(variables);
+
+        const int32_t dLvl = variables["level"].as<int32_t>();
+        if (dLvl < 1 || dLvl > 16)
+            throw bpo::error("level has to be a dungeon level, 1-16");
+
+        const std::string algorithm = variables["algorithm"].as<std::string>();
+        if (algorithm != "astar" && algorithm != "jps")
+            throw bpo::error("algorithm has to be astar or jps");
+
+        if (variables["searches"].as<int32_t>() < 1 || variables["rounds"].as<int32_t>() < 1 || variables["range"].as<int32_t>() < 1)
+            throw bpo::error("searches, rounds and range have to be at least 1");
+    }
+    catch (bpo::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+        return false;
+    }
+
+    return true;
+}
 
-ostream& operator<<(ostream& os, std::pair<int32_t, int32_t>& location)
+static Location randomPassable(const LayoutLevel& level, Location centre, int32_t range)
 {
-    os << "(" << location.first << "," << location.second << ")";
-    return os;
+    Location location;
+    do
+    {
+        location.first = centre.first + FALevelGen::randomInRange(0, range * 2) - range;
+        location.second = centre.second + FALevelGen::randomInRange(0, range * 2) - range;
+    } while (!level.isPassable(location.first, location.second));
+
+    return location;
 }
 
-void drawPath(::GameLevel::GameLevelImpl& graph,
-              int field_width,
-              unordered_map<std::pair<int32_t, int32_t>, int>* distances = 0,
-              unordered_map<std::pair<int32_t, int32_t>, std::pair<int32_t, int32_t>>* point_to = 0,
-              vector<std::pair<int32_t, int32_t>>* path = 0)
+static void drawPath(const LayoutLevel& level, Location start, Location goal, const std::vector<Location>& path)
 {
-    for (int y = 0; y != LevelImpl::MAP_SIZE; ++y)
+    for (int32_t y = 0; y < level.height(); y++)
     {
-        for (int x = 0; x != LevelImpl::MAP_SIZE; ++x)
+        for (int32_t x = 0; x < level.width(); x++)
         {
-            std::pair<int32_t, int32_t> id;
-            id.first = x;
-            id.second = y;
-            cout << left << setw(field_width);
-            if (!graph.isPassable(x, y))
-            {
-                cout << string(field_width, '#');
-            }
-            else if (point_to != 0 && point_to->count(id))
-            {
-                int x2, y2;
-                x2 = (*point_to)[id].first;
-                y2 = (*point_to)[id].second;
-
-                if (x2 == x + 1)
-                {
-                    cout << u8"\u2192 ";
-                }
-                else if (x2 == x - 1)
-                {
-                    cout << u8"\u2190 ";
-                }
-                else if (y2 == y + 1)
-                {
-                    cout << u8"\u2193 ";
-                }
-                else if (y2 == y - 1)
-                {
-                    cout << u8"\u2191 ";
-                }
-                else
-                {
-                    cout << "* ";
-                }
-            }
-            else if (distances != 0 && distances->count(id))
-            {
-                cout << (*distances)[id];
-            }
-            else if (path != 0 && find(path->begin(), path->end(), id) != path->end())
-            {
-                cout << '@';
-            }
+            Location location(x, y);
+
+            if (location == start)
+                std::cout << 'S';
+            else if (location == goal)
+                std::cout << 'G';
+            else if (std::find(path.begin(), path.end(), location) != path.end())
+                std::cout << '@';
             else
-            {
-                cout << '.';
-            }
+                std::cout << (level.isPassable(x, y) ? '.' : '#');
         }
-        cout << endl;
+
+        std::cout << std::endl;
     }
 }
 
-int main()
+int main(int argc, char** argv)
 {
-    using namespace FAWorld;
-    FAWorld::LevelImpl* level = new LevelImpl();
+    bpo::variables_map variables;
+    if (!parseOptions(argc, argv, variables))
+        return EXIT_FAILURE;
+
+    const int32_t seed = variables["seed"].as<int32_t>();
+    const int32_t dLvl = variables["level"].as<int32_t>();
+    const int32_t searchCount = variables["searches"].as<int32_t>();
+    const int32_t rounds = variables["rounds"].as<int32_t>();
+    const int32_t range = variables["range"].as<int32_t>();
+    const bool adjacent = variables.count("adjacent") != 0;
+    const FAWorld::PathAlgorithm algorithm =
+        variables["algorithm"].as<std::string>() == "jps" ? FAWorld::PathAlgorithm::JumpPoint : FAWorld::PathAlgorithm::AStar;
+
+    FALevelGen::FAsrand(seed);
+
+    // The same size World::generateLevels() asks for
+    LayoutLevel level(200, 200, FALevelGen::generatePassable(100, 100, dLvl));
+
+    std::vector<std::pair<Location, Location>> searches;
+    for (int32_t i = 0; i < searchCount; i++)
+    {
+        Location start = randomPassable(level, Location(level.width() / 2, level.height() / 2), level.width() / 2);
+        searches.push_back({start, randomPassable(level, start, range)});
+    }
+
+    std::cout << "seed " << seed << ", level " << dLvl << ", " << level.width() << "x" << level.height() << ", " << searchCount << " searches x " << rounds
+              << " rounds, " << variables["algorithm"].as<std::string>() << (adjacent ? ", adjacent" : "") << std::endl;
+
+    FAWorld::PathFinder pathFinder;
+    std::vector<Location> path;
 
-    std::pair<int32_t, int32_t> start, goal;
-    vector<std::pair<int32_t, int32_t>> path;
+    int32_t found = 0;
+    int64_t pathLength = 0;
+    int64_t expanded = 0;
+    int64_t scanned = 0;
+    int32_t mostScanned = 0;
 
-    int caseId = 1;
-    cout << "Select case ID [1-6]";
-    cin >> caseId;
+    for (const auto& search : searches)
+    {
+        Location goal = search.second;
+        bool arrivable = false;
+        pathFinder.find(&level, search.first, goal, arrivable, adjacent, path, algorithm);
+
+        found += arrivable;
+        pathLength += path.size();
+        expanded += pathFinder.expanded();
+        scanned += pathFinder.scanned();
+        mostScanned = std::max(mostScanned, pathFinder.scanned());
+    }
 
-    switch (caseId)
+    if (variables.count("draw"))
     {
-        case 1:
-            start = std::pair<int32_t, int32_t>(2, 4);
-            goal = std::pair<int32_t, int32_t>(18, 5);
-            break;
-        case 2:
-            start = std::pair<int32_t, int32_t>(18, 5);
-            goal = std::pair<int32_t, int32_t>(2, 3);
-            break;
-        case 3:
-            start = std::pair<int32_t, int32_t>(3, 10);
-            goal = std::pair<int32_t, int32_t>(18, 10);
-            break;
-        case 4:
-            // This case uses "findClosesPointToGoal"
-            start = std::pair<int32_t, int32_t>(3, 10);
-            goal = std::pair<int32_t, int32_t>(15, 10);
-            break;
-        case 5:
-            // This case uses "findClosesPointToGoal"
-            start = std::pair<int32_t, int32_t>(18, 7);
-            goal = std::pair<int32_t, int32_t>(10, 10);
-            break;
-        default:
-            // This case uses "findClosesPointToGoal"
-            start = std::pair<int32_t, int32_t>(18, 10);
-            goal = std::pair<int32_t, int32_t>(10, 10);
-            break;
+        Location goal = searches[0].second;
+        bool arrivable = false;
+        pathFinder.find(&level, searches[0].first, goal, arrivable, adjacent, path, algorithm);
+        drawPath(level, searches[0].first, searches[0].second, path);
     }
 
-    high_resolution_clock::time_point t1 = high_resolution_clock::now();
-    bool bArrivable = false;
-    path = pathFind(level, start, goal, bArrivable, false);
+    Misc::TimingHistogram searchTimes;
+    uint64_t startAllocations = Misc::AllocationCounter::count();
+    auto start = std::chrono::steady_clock::now();
+
+    for (int32_t round = 0; round < rounds; round++)
+    {
+        for (const auto& search : searches)
+        {
+            auto searchStart = std::chrono::steady_clock::now();
+
+            Location goal = search.second;
+            bool arrivable = false;
+            pathFinder.find(&level, search.first, goal, arrivable, adjacent, path, algorithm);
+
+            searchTimes.record(std::chrono::steady_clock::now() - searchStart);
+        }
+    }
 
-    high_resolution_clock::time_point t2 = high_resolution_clock::now();
+    auto total = std::chrono::steady_clock::now() - start;
+    uint64_t allocations = Misc::AllocationCounter::count() - startAllocations;
 
-    drawPath(*level, 2, 0, 0, &path);
+    double seconds = std::chrono::duration<double>(total).count();
+    int64_t totalSearches = int64_t(searchCount) * rounds;
 
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
-    cout << "Duration: " << duration << " us" << endl;
+    std::cout << std::fixed << std::setprecision(1) << "found " << found << "/" << searchCount << ", average path " << double(pathLength) / std::max(found, 1)
+              << " tiles, average " << double(expanded) / searchCount << " tiles expanded" << std::endl;
+    if (algorithm == FAWorld::PathAlgorithm::JumpPoint)
+        std::cout << "average " << double(scanned) / searchCount << " tiles scanned, most " << mostScanned << std::endl;
+    std::cout << std::setprecision(3) << seconds << "s, " << std::setprecision(2) << seconds * 1000000 / totalSearches << "us per search, search times: "
+              << searchTimes.summary() << std::endl;
+    std::cout << "allocations: " << allocations << " (" << double(allocations) / totalSearches << " per search)" << std::endl;
 
-    delete level;
-    return 0;
+    return EXIT_SUCCESS;
 }
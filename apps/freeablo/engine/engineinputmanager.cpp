@@ -172,6 +172,8 @@ namespace Engine
                 return "Accept";
             case KeyboardInputAction::reject:
                 return "Reject";
+            case KeyboardInputAction::toggleProfiler:
+                return "ToggleProfiler";
             case KeyboardInputAction::max:
                 break;
             default:
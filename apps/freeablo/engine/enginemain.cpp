@@ -9,13 +9,16 @@
 #include "../faworld/playerfactory.h"
 #include "../faworld/world.h"
 #include "threadmanager.h"
-#include <boost/asio.hpp>
 #include <boost/make_unique.hpp>
+#include <chrono>
 #include <enet/enet.h>
 #include <functional>
 #include <input/inputmanager.h>
 #include <iostream>
+#include <misc/fixedtimestep.h>
 #include <misc/misc.h>
+#include <misc/profiler.h>
+#include <misc/timinghistogram.h>
 #include <serial/textstream.h>
 #include <thread>
 
@@ -40,6 +43,8 @@ namespace Engine
         size_t resolutionWidth = settings.get<size_t>("Display", "resolutionWidth");
         size_t resolutionHeight = settings.get<size_t>("Display", "resolutionHeight");
         std::string fullscreen = settings.get<std::string>("Display", "fullscreen");
+        std::string vsync = settings.get<std::string>("Display", "vsync", "true");
+        uint32_t frameRateCap = settings.get<uint32_t>("Display", "frameRateCap", 0);
         std::string pathEXE = settings.get<std::string>("Game", "PathEXE");
         if (pathEXE == "")
         {
@@ -47,11 +52,11 @@ namespace Engine
         }
 
         Engine::ThreadManager threadManager;
-        FARender::Renderer renderer(resolutionWidth, resolutionHeight, fullscreen == "true");
+        FARender::Renderer renderer(resolutionWidth, resolutionHeight, fullscreen == "true", vsync == "true");
         mInputManager = std::make_shared<EngineInputManager>(renderer.getNuklearContext());
         mInputManager->registerKeyboardObserver(this);
         std::thread mainThread(std::bind(&EngineMain::runGameLoop, this, &variables, pathEXE));
-        threadManager.run();
+        threadManager.run(frameRateCap);
         renderDone = true;
 
         mainThread.join();
@@ -59,6 +64,9 @@ namespace Engine
 
     void EngineMain::runGameLoop(const bpo::variables_map& variables, const std::string& pathEXE)
     {
+#ifdef FA_PROFILER
+        Misc::Profiler::setThreadName("game");
+#endif
         FALevelGen::FAsrand(static_cast<int>(time(nullptr)));
 
         FARender::Renderer& renderer = *FARender::Renderer::get();
@@ -132,16 +140,34 @@ namespace Engine
             mInputManager->registerMouseObserver(mWorld.get());
         }
 
-        boost::asio::io_service io;
+        // If we fall further behind than this, the game slows down rather than trying to catch up
+        const uint32_t maxCatchUpTicks = FAWorld::World::getTicksInPeriod(0.1f);
+        Misc::FixedTimestep timestep(FAWorld::World::ticksPerSecond, maxCatchUpTicks);
+
+        Misc::TimingHistogram tickTimes;
+        uint64_t ticksSinceReport = 0;
+        uint64_t lastSkippedTicks = 0;
 
         // Main game logic loop
         while (!mDone)
         {
-            boost::asio::deadline_timer timer(io, boost::posix_time::milliseconds(1000 / FAWorld::World::ticksPerSecond));
+            uint32_t ticks = timestep.stepsDue();
+            if (ticks == 0)
+            {
+                timestep.waitForNextStep();
+                continue;
+            }
 
             mInputManager->update(mPaused);
-            if (!mPaused && inGame)
-                mWorld->update(mNoclip);
+            for (uint32_t i = 0; i < ticks; i++)
+            {
+                auto tickStart = std::chrono::steady_clock::now();
+
+                if (!mPaused && inGame)
+                    mWorld->update(mNoclip);
+
+                tickTimes.record(std::chrono::steady_clock::now() - tickStart);
+            }
 
             nk_context* ctx = renderer.getNuklearContext();
             if (inGame)
@@ -150,28 +176,26 @@ namespace Engine
                 mGuiManager->updateMenuUI(ctx);
 
             FARender::RenderState* state = renderer.getFreeState();
-            if (state)
+            if (mPlayer)
             {
-                if (mPlayer)
-                {
-                    auto level = mWorld->getCurrentLevel();
-                    state->mPos = mPlayer->getPos();
-                    if (level != NULL)
-                        state->tileset = renderer.getTileset(*level);
-                    state->level = level;
-                    mWorld->fillRenderState(state);
-                }
-                else
-                    state->level = nullptr;
-                if (!FAGui::cursorPath.empty())
-                    state->mCursorEmpty = false;
-                else
-                    state->mCursorEmpty = true;
-                state->mCursorFrame = FAGui::cursorFrame;
-                state->mCursorSpriteGroup = renderer.loadImage("data/inv/objcurs.cel");
-                state->mCursorHotspot = FAGui::cursorHotspot;
-                state->nuklearData.fill(ctx);
+                auto level = mWorld->getCurrentLevel();
+                state->mPos = mPlayer->getPos();
+                state->mTickTime = timestep.lastStepTime();
+                if (level != NULL)
+                    state->tileset = renderer.getTileset(*level);
+                state->level = level;
+                mWorld->fillRenderState(state, renderer.getVisibleTiles(state->mPos));
             }
+            else
+                state->level = nullptr;
+            if (!FAGui::cursorPath.empty())
+                state->mCursorEmpty = false;
+            else
+                state->mCursorEmpty = true;
+            state->mCursorFrame = FAGui::cursorFrame;
+            state->mCursorSpriteGroup = renderer.loadImage("data/inv/objcurs.cel");
+            state->mCursorHotspot = FAGui::cursorHotspot;
+            state->nuklearData.fill(ctx);
 
             std::vector<uint32_t> spritesToPreload;
             if (renderer.getAndClearSpritesNeedingPreloading(spritesToPreload))
@@ -181,12 +205,20 @@ namespace Engine
 
             renderer.setCurrentState(state);
 
-            auto remainingTickTime = timer.expires_from_now().total_milliseconds();
-
-            if (remainingTickTime < 0)
-                std::cerr << "tick time exceeded by " << -remainingTickTime << "ms" << std::endl;
+            // only worth mentioning if we're not keeping up
+            ticksSinceReport += ticks;
+            if (ticksSinceReport >= FAWorld::World::ticksPerSecond)
+            {
+                if (tickTimes.max() > timestep.stepLength() || timestep.skippedSteps() != lastSkippedTicks)
+                {
+                    std::cerr << "tick time exceeded, tick times: " << tickTimes.summary() << ", skipped ticks: " << timestep.skippedSteps() - lastSkippedTicks
+                              << std::endl;
+                }
 
-            timer.wait();
+                tickTimes.clear();
+                ticksSinceReport = 0;
+                lastSkippedTicks = timestep.skippedSteps();
+            }
         }
 
         renderer.stop();
@@ -212,6 +244,10 @@ namespace Engine
         {
             toggleNoclip();
         }
+        else if (action == KeyboardInputAction::toggleProfiler)
+        {
+            toggleProfiler();
+        }
     }
 
     void EngineMain::setupNewPlayer(FAWorld::Player* player)
@@ -235,6 +271,28 @@ namespace Engine
 
     void EngineMain::stop() { mDone = true; }
 
+    void EngineMain::toggleProfiler()
+    {
+#ifdef FA_PROFILER
+        if (!Misc::Profiler::isEnabled())
+        {
+            std::cout << "profiler started" << std::endl;
+            Misc::Profiler::setEnabled(true);
+            return;
+        }
+
+        Misc::Profiler::setEnabled(false);
+
+        const std::string path = "profile.json";
+        if (Misc::Profiler::writeChromeTrace(path))
+            std::cout << "profiler stopped, trace written to " << path << std::endl;
+        else
+            std::cerr << "profiler stopped, failed to write " << path << std::endl;
+#else
+        std::cout << "not built with the profiler, reconfigure with -DFA_PROFILER=ON" << std::endl;
+#endif
+    }
+
     void EngineMain::togglePause()
     {
         mPaused = !mPaused;
@@ -32,6 +32,7 @@ namespace Engine
         void stop();
         void togglePause();
         void toggleNoclip();
+        void toggleProfiler(); ///< starts profiling, or stops it and writes out the trace
         void notify(KeyboardInputAction action);
         void setupNewPlayer(FAWorld::Player* player);
         // TODO: replace with enums
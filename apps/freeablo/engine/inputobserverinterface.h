@@ -21,6 +21,7 @@ namespace Engine
         prevOption,
         accept,
         reject,
+        toggleProfiler,
 
         max
     };
@@ -2,8 +2,13 @@
 
 #include <chrono>
 #include <iostream>
+#include <memory>
 
 #include <input/inputmanager.h>
+#include <misc/assert.h>
+#include <misc/fixedtimestep.h>
+#include <misc/profiler.h>
+#include <misc/timinghistogram.h>
 
 #include "../farender/renderer.h"
 
@@ -12,10 +17,20 @@ namespace Engine
     ThreadManager* ThreadManager::mThreadManager = NULL;
     ThreadManager* ThreadManager::get() { return mThreadManager; }
 
-    ThreadManager::ThreadManager() : mRenderState(NULL), mAudioManager(50, 100) { mThreadManager = this; }
+    ThreadManager::ThreadManager(bool headless) : mHeadless(headless)
+    {
+        if (!headless)
+            mAudioManager.reset(new FAAudio::AudioManager(50, 100));
+
+        mThreadManager = this;
+    }
 
-    void ThreadManager::run()
+    void ThreadManager::run(uint32_t frameRateCap)
     {
+#ifdef FA_PROFILER
+        Misc::Profiler::setThreadName("render");
+#endif
+        release_assert(!mHeadless); // there's no render thread when headless
         const int MAXIMUM_DURATION_IN_MS = 1000;
         Input::InputManager* inputManager = Input::InputManager::get();
         FARender::Renderer* renderer = FARender::Renderer::get();
@@ -24,9 +39,25 @@ namespace Engine
 
         auto last = std::chrono::system_clock::now();
         size_t numFrames = 0;
+        uint64_t lastDropped = 0;
+        uint64_t lastStale = 0;
+
+        // frame to frame times, so uneven pacing shows up even when the average FPS looks fine
+        Misc::TimingHistogram frameTimes;
+        auto lastFrame = std::chrono::steady_clock::now();
+
+        std::unique_ptr<Misc::FixedTimestep> frameLimiter;
+        if (frameRateCap)
+            frameLimiter.reset(new Misc::FixedTimestep(frameRateCap, 1));
 
         while (true)
         {
+            if (frameLimiter)
+            {
+                frameLimiter->waitForNextStep();
+                frameLimiter->stepsDue();
+            }
+
             mSpritesToPreload.clear();
 
             while (mQueue.pop(message))
@@ -34,9 +65,13 @@ namespace Engine
 
             inputManager->poll();
 
-            if (!renderer->renderFrame(mRenderState, mSpritesToPreload))
+            if (!renderer->renderFrame(renderer->getLatestState(), mSpritesToPreload))
                 break;
 
+            auto frameEnd = std::chrono::steady_clock::now();
+            frameTimes.record(frameEnd - lastFrame);
+            lastFrame = frameEnd;
+
             auto now = std::chrono::system_clock::now();
             numFrames++;
 
@@ -45,9 +80,16 @@ namespace Engine
 
             if (duration >= MAXIMUM_DURATION_IN_MS)
             {
-                std::cout << "FPS: " << ((float)numFrames) / (((float)duration) / MAXIMUM_DURATION_IN_MS) << std::endl;
+                uint64_t dropped = renderer->droppedStateCount();
+                uint64_t stale = renderer->staleStateCount();
+
+                std::cout << "FPS: " << ((float)numFrames) / (((float)duration) / MAXIMUM_DURATION_IN_MS) << ", dropped states: " << dropped - lastDropped
+                          << ", stale frames: " << stale - lastStale << ", frame times: " << frameTimes.summary() << std::endl;
+                frameTimes.clear();
                 numFrames = 0;
                 last = now;
+                lastDropped = dropped;
+                lastStale = stale;
             }
         }
 
@@ -56,6 +98,9 @@ namespace Engine
 
     void ThreadManager::playMusic(const std::string& path)
     {
+        if (mHeadless)
+            return;
+
         Message message;
         message.type = ThreadState::PLAY_MUSIC;
         message.data.musicPath = new std::string(path);
@@ -71,6 +116,9 @@ namespace Engine
             return;
         }
 
+        if (mHeadless)
+            return;
+
         Message message;
         message.type = ThreadState::PLAY_SOUND;
         message.data.soundPath = new std::string(path);
@@ -80,22 +128,19 @@ namespace Engine
 
     void ThreadManager::stopSound()
     {
-        Message message;
-        message.type = ThreadState::STOP_SOUND;
-        mQueue.push(message);
-    }
+        if (mHeadless)
+            return;
 
-    void ThreadManager::sendRenderState(FARender::RenderState* state)
-    {
         Message message;
-        message.type = ThreadState::RENDER_STATE;
-        message.data.renderState = state;
-
+        message.type = ThreadState::STOP_SOUND;
         mQueue.push(message);
     }
 
     void ThreadManager::sendSpritesForPreload(std::vector<uint32_t> sprites)
     {
+        if (mHeadless)
+            return;
+
         Message message;
         message.type = ThreadState::PRELOAD_SPRITES;
         message.data.preloadSpriteIds = new std::vector<uint32_t>(sprites);
@@ -109,32 +154,24 @@ namespace Engine
         {
             case ThreadState::PLAY_MUSIC:
             {
-                mAudioManager.playMusic(*message.data.musicPath);
+                mAudioManager->playMusic(*message.data.musicPath);
                 delete message.data.musicPath;
                 break;
             }
 
             case ThreadState::PLAY_SOUND:
             {
-                mAudioManager.playSound(*message.data.soundPath);
+                mAudioManager->playSound(*message.data.soundPath);
                 delete message.data.soundPath;
                 break;
             }
 
             case ThreadState::STOP_SOUND:
             {
-                mAudioManager.stopSound();
+                mAudioManager->stopSound();
                 break;
             }
 
-            case ThreadState::RENDER_STATE:
-            {
-                if (mRenderState && mRenderState != message.data.renderState)
-                    mRenderState->ready = true;
-
-                mRenderState = message.data.renderState;
-                break;
-            }
             case ThreadState::PRELOAD_SPRITES:
             {
                 mSpritesToPreload.insert(mSpritesToPreload.end(), message.data.preloadSpriteIds->begin(), message.data.preloadSpriteIds->end());
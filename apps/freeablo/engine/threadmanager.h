@@ -2,15 +2,12 @@
 #define THREAD_MANAGER_H
 
 #include <boost/lockfree/spsc_queue.hpp>
+#include <memory>
+#include <stdint.h>
 #include <string>
 
 #include "../faaudio/audiomanager.h"
 
-namespace FARender
-{
-    class RenderState;
-}
-
 namespace Engine
 {
     enum class ThreadState
@@ -18,7 +15,6 @@ namespace Engine
         PLAY_MUSIC,
         PLAY_SOUND,
         STOP_SOUND,
-        RENDER_STATE,
         PRELOAD_SPRITES
     };
 
@@ -30,7 +26,6 @@ namespace Engine
         {
             std::string* musicPath;
             std::string* soundPath;
-            FARender::RenderState* renderState;
             std::vector<uint32_t>* preloadSpriteIds;
         } data;
     };
@@ -39,12 +34,12 @@ namespace Engine
     {
     public:
         static ThreadManager* get();
-        ThreadManager();
-        void run();
+        /// headless: no audio device is opened, and everything sent to the render thread is dropped, as there isn't one
+        explicit ThreadManager(bool headless = false);
+        void run(uint32_t frameRateCap); ///< frameRateCap = 0 for no cap, other than vsync
         void playMusic(const std::string& path);
         void playSound(const std::string& path);
         void stopSound();
-        void sendRenderState(FARender::RenderState* state);
         void sendSpritesForPreload(std::vector<uint32_t> sprites);
 
     private:
@@ -52,8 +47,8 @@ namespace Engine
 
         static ThreadManager* mThreadManager; ///< Singleton instance
         boost::lockfree::spsc_queue<Message, boost::lockfree::capacity<100>> mQueue;
-        FARender::RenderState* mRenderState;
-        FAAudio::AudioManager mAudioManager;
+        bool mHeadless;
+        std::unique_ptr<FAAudio::AudioManager> mAudioManager; ///< nullptr when headless
 
         std::vector<uint32_t> mSpritesToPreload;
     };
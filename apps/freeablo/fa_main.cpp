@@ -56,6 +56,9 @@ int fa_main(int argc, char** argv)
         return EXIT_FAILURE;
     }
 
+    if (settings.get<std::string>("Cache", "enabled") == "true")
+        FAIO::initDiskCache(settings.get<std::string>("Cache", "directory"), settings.get<uint64_t>("Cache", "maxSizeMB") * 1024 * 1024);
+
     Engine::EngineMain engine;
 
     int retval = EXIT_SUCCESS;
@@ -1,6 +1,7 @@
 #include "audiomanager.h"
 #include <iostream>
 #include <misc/assert.h>
+#include <misc/profiler.h>
 #include <string>
 
 namespace FAAudio
@@ -24,6 +25,8 @@ namespace FAAudio
 
     void AudioManager::playSound(const std::string& path)
     {
+        FA_PROFILE_ZONE("AudioManager::playSound");
+
         if (mCache.find(path) == mCache.end())
         {
             if (mCount >= mCacheSize)
@@ -56,7 +59,7 @@ namespace FAAudio
 
                 CacheEntry toEvict = mCache[*it];
 
-                Audio::freeMusic(toEvict.sound);
+                Audio::freeSound(toEvict.sound);
 
                 mCache.erase(*it);
                 mUsedList.erase(--(it.base()));
@@ -900,7 +900,7 @@ namespace FALevelGen
             {
                 xPos = randomInRange(1, levelBase.width() - 1);
                 yPos = randomInRange(1, levelBase.height() - 1);
-            } while (!levelBase[xPos][yPos].passable() && !levelBase.isStairs(xPos, yPos));
+            } while (!levelBase.isPassable(xPos, yPos) && !levelBase.isStairs(xPos, yPos));
 
             std::string name = possibleMonsters[randomInRange(0, possibleMonsters.size() - 1)]->monsterName;
             DiabloExe::Monster monster = exe.getMonster(name);
@@ -1198,4 +1198,21 @@ namespace FALevelGen
 
         return retval;
     }
+
+    std::vector<uint8_t> generatePassable(int32_t width, int32_t height, int32_t dLvl)
+    {
+        int32_t levelNum = ((dLvl - 1) / 4) + 1;
+
+        Level::Dun tmpLevel = generateTmp(width, height, levelNum);
+
+        // Each tile of the layout is 2x2 tiles of the finished level
+        std::vector<uint8_t> passable(width * 2 * height * 2);
+        for (int32_t y = 0; y < height * 2; y++)
+        {
+            for (int32_t x = 0; x < width * 2; x++)
+                passable[x + y * width * 2] = isPassable(x / 2, y / 2, tmpLevel);
+        }
+
+        return passable;
+    }
 }
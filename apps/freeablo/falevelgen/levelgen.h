@@ -12,6 +12,10 @@ namespace FALevelGen
 {
 
     FAWorld::GameLevel* generate(int32_t width, int32_t height, int32_t dLvl, const DiabloExe::DiabloExe& exe, int32_t previous, int32_t next);
+
+    /// Only the layout generate() would start from, so it needs no game data: the walkable tiles of a level the size generate()
+    /// makes, (width * 2) x (height * 2), indexed x + y * width * 2. For tools and benchmarks that can't load a real level.
+    std::vector<uint8_t> generatePassable(int32_t width, int32_t height, int32_t dLvl);
 }
 
 #endif
@@ -9,9 +9,9 @@
 #include <misc/assert.h>
 #include <misc/stringops.h>
 
-#include "../engine/threadmanager.h"
 #include "../fagui/guimanager.h"
 #include "../faworld/gamelevel.h"
+#include "../faworld/world.h"
 #include "cel/celdecoder.h"
 #include "fontinfo.h"
 #include <boost/format.hpp>
@@ -28,6 +28,12 @@ namespace FARender
 
     Renderer* Renderer::mRenderer = NULL;
 
+    union I32sAs64
+    {
+        int32_t int32s[2];
+        int64_t int64;
+    };
+
     std::unique_ptr<CelFontInfo> Renderer::generateCelFont(const std::string& texturePath, const DiabloExe::FontData& fontData, int spacing)
     {
         std::unique_ptr<CelFontInfo> ret(new CelFontInfo());
@@ -82,7 +88,8 @@ namespace FARender
         return handle;
     }
 
-    Renderer::Renderer(int32_t windowWidth, int32_t windowHeight, bool fullscreen) : mDone(false), mSpriteManager(1024), mWidthHeightTmp(0)
+    Renderer::Renderer(int32_t windowWidth, int32_t windowHeight, bool fullscreen, bool vsync, bool headless)
+        : mDone(false), mHeadless(headless), mSpriteManager(1024), mWidthHeightTmp(0)
     {
         release_assert(!mRenderer); // singleton, only one instance
 
@@ -92,16 +99,25 @@ namespace FARender
             settings.windowWidth = windowWidth;
             settings.windowHeight = windowHeight;
             settings.fullscreen = fullscreen;
+            settings.vsync = vsync;
 
             nk_init_default(&mNuklearContext, nullptr);
             mNuklearContext.clip.copy = nullptr;  // nk_sdl_clipbard_copy;
             mNuklearContext.clip.paste = nullptr; // nk_sdl_clipbard_paste;
             mNuklearContext.clip.userdata = nk_handle_ptr(0);
 
-            Render::init("Freeablo", settings, mNuklearGraphicsData, &mNuklearContext);
+            if (!mHeadless)
+                Render::init("Freeablo", settings, mNuklearGraphicsData, &mNuklearContext);
+
+            // so the game thread has the right size before the first frame is drawn
+            I32sAs64 tmp;
+            tmp.int32s[0] = mHeadless ? windowWidth : Render::WIDTH;
+            tmp.int32s[1] = mHeadless ? windowHeight : Render::HEIGHT;
+            mWidthHeightTmp = tmp.int64;
 
             // Load Fonts: if none of these are loaded a default font will be used
             // Load Cursor: if you uncomment cursor loading please hide the cursor
+            if (!mHeadless)
             {
                 nk_fa_font_stash_begin(mNuklearGraphicsData.atlas);
                 // struct nk_font *droid = nk_font_atlas_add_from_file(atlas, "../../../extra_font/DroidSans.ttf", 14, 0);
@@ -116,10 +132,7 @@ namespace FARender
                 // nk_style_set_font(ctx, &roboto->handle);
             }
 
-            mStates = (RenderState*)malloc(sizeof(RenderState) * mNumRenderStates);
-
-            for (size_t i = 0; i < mNumRenderStates; ++i)
-                new (mStates + i) RenderState(mNuklearGraphicsData);
+            mStates.forEachSlot([&](RenderState& state) { state.nuklearData.init(mNuklearGraphicsData.dev); });
 
             mRenderer = this;
         }
@@ -129,14 +142,12 @@ namespace FARender
     {
         mRenderer = NULL;
 
-        for (size_t i = 0; i < mNumRenderStates; ++i)
-            mStates[i].~RenderState();
-
-        free(mStates);
-        destroyNuklearGraphicsContext(mNuklearGraphicsData);
+        if (!mHeadless)
+            destroyNuklearGraphicsContext(mNuklearGraphicsData);
         nk_free(&mNuklearContext);
 
-        Render::quit();
+        if (!mHeadless)
+            Render::quit();
     }
 
     void Renderer::stop() { mDone = true; }
@@ -151,21 +162,44 @@ namespace FARender
         return tileset;
     }
 
-    RenderState* Renderer::getFreeState()
+    void RenderState::clearObjects(int32_t levelWidth, int32_t levelHeight)
     {
-        for (size_t i = 0; i < mNumRenderStates; i++)
+        for (Render::LevelObjects* objects : {&mItems, &mObjects})
         {
-            if (mStates[i].ready)
-            {
-                mStates[i].ready = false;
-                return &mStates[i];
-            }
+            if (objects->width() != levelWidth || objects->height() != levelHeight)
+                objects->resize(levelWidth, levelHeight);
+
+            objects->clear();
         }
+    }
+
+    void RenderState::addObject(
+        Render::LevelObjects& dst, FASpriteGroup* spriteGroup, uint32_t frame, const FAWorld::Position& position, boost::optional<Cel::Colour> hoverColor)
+    {
+        Render::LevelObject obj;
+        obj.spriteCacheIndex = spriteGroup->getCacheIndex();
+        obj.spriteFrame = frame;
+        obj.x2 = position.next().first;
+        obj.y2 = position.next().second;
+        obj.dist = position.getDist();
+        obj.distPerTick = position.getDistPerTick();
+
+        dst.add(position.current().first, position.current().second, obj, hoverColor);
+    }
 
-        return NULL;
+    RenderState* Renderer::getFreeState() { return &mStates.back(); }
+
+    void Renderer::setCurrentState(RenderState* current)
+    {
+        release_assert(current == &mStates.back());
+        mStates.publish();
     }
 
-    void Renderer::setCurrentState(RenderState* current) { Engine::ThreadManager::get()->sendRenderState(current); }
+    RenderState* Renderer::getLatestState() { return mStates.latest(); }
+
+    uint64_t Renderer::droppedStateCount() const { return mStates.droppedCount(); }
+
+    uint64_t Renderer::staleStateCount() const { return mStates.staleCount(); }
 
     FASpriteGroup* Renderer::loadImage(const std::string& path) { return mSpriteManager.get(path); }
 
@@ -181,6 +215,15 @@ namespace FARender
             x, y, screenPos.current().first, screenPos.current().second, screenPos.next().first, screenPos.next().second, screenPos.getDist());
     }
 
+    Misc::TileRect Renderer::getVisibleTiles(const FAWorld::Position& screenPos)
+    {
+        int32_t w, h;
+        getWindowDimensions(w, h);
+
+        return Render::getVisibleTiles(
+            w, h, screenPos.current().first, screenPos.current().second, screenPos.next().first, screenPos.next().second, screenPos.getDist());
+    }
+
     void Renderer::waitUntilDone()
     {
         std::unique_lock<std::mutex> lk(mDoneMutex);
@@ -188,45 +231,6 @@ namespace FARender
             mDoneCV.wait(lk);
     }
 
-    union I32sAs64
-    {
-        int32_t int32s[2];
-        int64_t int64;
-    };
-
-    static void fill(const FAWorld::GameLevel& level, const std::vector<ObjectToRender> src, Render::LevelObjects& dst)
-    {
-        if (dst.width() != level.width() || dst.height() != level.height())
-            dst.resize(level.width(), level.height());
-
-        for (int32_t x = 0; x < dst.width(); x++)
-        {
-            for (int32_t y = 0; y < dst.height(); y++)
-            {
-                dst[x][y].clear();
-            }
-        }
-
-        for (size_t i = 0; i < src.size(); i++)
-        {
-            auto& object = src[i];
-            auto& position = object.position;
-
-            Render::LevelObject obj;
-            obj.spriteCacheIndex = object.spriteGroup->getCacheIndex();
-            obj.spriteFrame = object.frame;
-            obj.x2 = position.next().first;
-            obj.y2 = position.next().second;
-            obj.dist = position.getDist();
-            obj.hoverColor = object.hoverColor;
-            obj.valid = true;
-
-            size_t x = position.current().first;
-            size_t y = position.current().second;
-            dst[x][y].push_back(std::move(obj));
-        }
-    }
-
     bool Renderer::renderFrame(RenderState* state, const std::vector<uint32_t>& spritesToPreload)
     {
         if (mDone)
@@ -253,33 +257,24 @@ namespace FARender
         {
             if (state->level)
             {
-                if (mLevelObjects.width() != state->level->width() || mLevelObjects.height() != state->level->height())
-                    mLevelObjects.resize(state->level->width(), state->level->height());
-
-                for (int32_t x = 0; x < mLevelObjects.width(); x++)
-                {
-                    for (int32_t y = 0; y < mLevelObjects.height(); y++)
-                    {
-                        if (mLevelObjects[x][y].size() > 0)
-                        {
-                            mLevelObjects[x][y].clear();
-                        }
-                    }
-                }
-                fill(*state->level, state->mObjects, mLevelObjects);
-                fill(*state->level, state->mItems, mItems);
+                // The state is a snapshot of the last tick, but we're usually drawing some time after it. Moving things
+                // are drawn as far along as they'll be by now, so movement is smooth whatever the frame rate.
+                std::chrono::duration<float> sinceTick = std::chrono::steady_clock::now() - state->mTickTime;
+                float tickFraction = std::min(std::max(sinceTick.count() / FAWorld::World::getSecondsPerTick(), 0.0f), 1.0f);
+                float cameraDist = std::min(state->mPos.getDist() + tickFraction * state->mPos.getDistPerTick(), 100.0f);
 
                 Render::drawLevel(state->level->mLevel,
                                   state->tileset.minTops->getCacheIndex(),
                                   state->tileset.minBottoms->getCacheIndex(),
                                   &mSpriteManager,
-                                  mLevelObjects,
-                                  mItems,
+                                  state->mObjects,
+                                  state->mItems,
                                   state->mPos.current().first,
                                   state->mPos.current().second,
                                   state->mPos.next().first,
                                   state->mPos.next().second,
-                                  state->mPos.getDist());
+                                  cameraDist,
+                                  tickFraction);
             }
 
             Render::drawGui(state->nuklearData, &mSpriteManager);
@@ -304,9 +299,10 @@ namespace FARender
 
         if (!State->mCursorEmpty)
         {
-            Render::Sprite sprite = mSpriteManager.get(State->mCursorSpriteGroup->getCacheIndex())->operator[](State->mCursorFrame);
-            Render::spriteSize(sprite, mCursorSize.x, mCursorSize.y);
-            Render::drawCursor(sprite, State->mCursorHotspot);
+            Render::SpriteGroup* cursorGroup = mSpriteManager.get(State->mCursorSpriteGroup->getCacheIndex());
+            mCursorSize.x = cursorGroup->frameWidth(State->mCursorFrame);
+            mCursorSize.y = cursorGroup->frameHeight(State->mCursorFrame);
+            Render::drawCursor(cursorGroup->operator[](State->mCursorFrame), State->mCursorHotspot);
         }
         else
         {
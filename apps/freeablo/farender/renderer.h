@@ -5,6 +5,7 @@
 #include <stdint.h>
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <map>
 #include <memory>
@@ -20,6 +21,7 @@
 #include "fontinfo.h"
 #include "spritemanager.h"
 #include <memory>
+#include <misc/triplebuffer.h>
 
 namespace Render
 {
@@ -45,23 +47,19 @@ namespace FARender
         friend class Renderer;
     };
 
-    struct ObjectToRender
-    {
-        FASpriteGroup* spriteGroup;
-        uint32_t frame;
-        FAWorld::Position position;
-        boost::optional<Cel::Colour> hoverColor;
-    };
-
+    ///
+    /// Everything the render thread needs to draw one frame, filled in by the game thread.
+    /// These are reused rather than recreated every tick (see Renderer::getFreeState()), so the object lists are built
+    /// straight into the LevelObjects the renderer draws from, and keep their capacity between ticks.
+    ///
     class RenderState
     {
     public:
-        std::atomic_bool ready;
-
         FAWorld::Position mPos;
+        std::chrono::steady_clock::time_point mTickTime; ///< when the tick this is a snapshot of was due, objects are drawn moved on from there
 
-        std::vector<ObjectToRender> mItems;
-        std::vector<ObjectToRender> mObjects;
+        Render::LevelObjects mItems;
+        Render::LevelObjects mObjects;
 
         NuklearFrameDump nuklearData;
 
@@ -75,7 +73,10 @@ namespace FARender
 
         bool mCursorEmpty;
 
-        RenderState(Render::NuklearGraphicsContext& nuklearGraphicsData) : ready(true), nuklearData(nuklearGraphicsData.dev) {}
+        /// Empties mItems and mObjects, and sizes them for a level
+        void clearObjects(int32_t levelWidth, int32_t levelHeight);
+        static void addObject(
+            Render::LevelObjects& dst, FASpriteGroup* spriteGroup, uint32_t frame, const FAWorld::Position& position, boost::optional<Cel::Colour> hoverColor);
     };
 
     FASpriteGroup* getDefaultSprite();
@@ -85,7 +86,9 @@ namespace FARender
     public:
         static Renderer* get();
 
-        Renderer(int32_t windowWidth, int32_t windowHeight, bool fullscreen);
+        /// headless: don't open a window or touch GL at all. Sprites only get their sizes loaded, and nothing can be drawn,
+        /// but everything the game thread uses still works, so the simulation can run on machines without a GPU.
+        Renderer(int32_t windowWidth, int32_t windowHeight, bool fullscreen, bool vsync, bool headless = false);
         ~Renderer();
 
         void stop();
@@ -93,8 +96,13 @@ namespace FARender
 
         Tileset getTileset(const FAWorld::GameLevel& level);
 
-        RenderState* getFreeState(); // ooh ah up de ra
+        /// The state for the game thread to fill in this tick, always the same one until it's handed over by setCurrentState()
+        RenderState* getFreeState();
         void setCurrentState(RenderState* current);
+        /// The most recent state handed over by the game thread, nullptr before the first one. To be called only by Engine::ThreadManager
+        RenderState* getLatestState();
+        uint64_t droppedStateCount() const; ///< states the game thread handed over that were never drawn
+        uint64_t staleStateCount() const;   ///< frames drawn from the same state as the frame before
 
         FASpriteGroup* loadImage(const std::string& path);
         FASpriteGroup* loadServerImage(uint32_t index);
@@ -102,6 +110,8 @@ namespace FARender
         std::string getPathForIndex(uint32_t index);
 
         Render::Tile getTileByScreenPos(size_t x, size_t y, const FAWorld::Position& screenPos);
+        /// The tiles that can end up on screen with the camera at screenPos, safe to call from the game thread
+        Misc::TileRect getVisibleTiles(const FAWorld::Position& screenPos);
 
         void drawCursor(RenderState* State);
 
@@ -128,11 +138,9 @@ namespace FARender
         static Renderer* mRenderer; ///< Singleton instance
 
         std::atomic_bool mDone;
-        Render::LevelObjects mLevelObjects;
-        Render::LevelObjects mItems;
+        bool mHeadless;
 
-        size_t mNumRenderStates = 15;
-        RenderState* mStates;
+        Misc::TripleBuffer<RenderState> mStates;
 
         SpriteManager mSpriteManager;
         Misc::Point mCursorSize;
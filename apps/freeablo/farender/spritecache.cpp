@@ -6,6 +6,8 @@
 #include <sstream>
 
 #include <cel/celfile.h>
+#include <faio/faio.h>
+#include <misc/profiler.h>
 #include <misc/stringops.h>
 #include <numeric>
 
@@ -28,10 +30,15 @@ namespace FARender
 
     FASpriteGroup* SpriteCache::get(const std::string& path)
     {
+        FA_PROFILE_ZONE("SpriteCache::get(path)");
+
         if (!mStrToCache.count(path))
         {
             std::vector<std::string> components = Misc::StringUtils::split(path, '&');
 
+            // The render thread will need the file shortly after getImageInfo, so have it decompressed once and kept around
+            FAIO::prefetch({components[0]}, FAIO::PREFETCH_PRIORITY_IMMEDIATE);
+
             std::vector<int32_t> tmpWidth, tmpHeight;
             int32_t tmpAnimLength;
             Render::getImageInfo(components[0], tmpWidth, tmpHeight, tmpAnimLength);
@@ -85,6 +92,8 @@ namespace FARender
 
         if (!mStrToTilesetCache.count(key))
         {
+            FAIO::prefetch({celPath, minPath}, FAIO::PREFETCH_PRIORITY_IMMEDIATE);
+
             FASpriteGroup* newCacheEntry = allocNewSpriteGroup();
             uint32_t cacheIndex = newUniqueIndex();
             newCacheEntry->init(0, {}, {}, cacheIndex);
@@ -112,6 +121,9 @@ namespace FARender
     {
         if (!mCache.count(index))
         {
+            // Only loads, this is called for every sprite drawn and hits are covered by the caller's zone (Render::drawLevel)
+            FA_PROFILE_ZONE("SpriteCache::get");
+
             if (mCurrentSize >= mMaxSize)
                 evict();
 
@@ -166,8 +166,9 @@ namespace FAWorld
         if (currentLevel)
             currentLevel->removeActor(this);
 
-        level->addActor(this);
+        // the position has to be set first, as that's where the level will put us
         mMoveHandler.teleport(level, pos);
+        level->addActor(this);
     }
 
     GameLevel* Actor::getLevel() { return mMoveHandler.getLevel(); }
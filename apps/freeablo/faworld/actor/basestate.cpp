@@ -2,6 +2,7 @@
 
 #include "../actor.h"
 #include "../itemmap.h"
+#include "../player.h"
 #include "attackstate.h"
 
 namespace FAWorld
@@ -22,7 +23,13 @@ namespace FAWorld
                                                     {
                                                         // move to the actor, if we're not already on our way
                                                         if (!actor.getPos().isNear(target->getPos()))
-                                                            actor.mMoveHandler.setDestination(target->getPos().current());
+                                                        {
+                                                            // there are few players and lots chasing them, so they share a flow field each
+                                                            if (target->getTypeId() == Player::typeId)
+                                                                actor.mMoveHandler.chase(target);
+                                                            else
+                                                                actor.mMoveHandler.setDestination(target->getPos().current());
+                                                        }
                                                         else // and interact them if in range
                                                         {
                                                             if (actor.canIAttack(target) && actor.attack(target))
@@ -0,0 +1,171 @@
+#include "actorgrid.h"
+
+#include <algorithm>
+#include <misc/assert.h>
+
+namespace FAWorld
+{
+    constexpr ActorGrid::Handle ActorGrid::NO_HANDLE;
+    constexpr size_t ActorGrid::MAX_ACTORS;
+    constexpr ActorGrid::Link ActorGrid::END;
+
+    ActorGrid::ActorGrid(int32_t width, int32_t height) : mWidth(width), mHeight(height), mCells(width * height, END), mBlockingCounts(width * height, 0) {}
+
+    ActorGrid::Handle ActorGrid::add(Actor* actor, Tile current, Tile next, bool blocking)
+    {
+        Handle handle;
+        if (!mFreeHandles.empty())
+        {
+            handle = mFreeHandles.back();
+            mFreeHandles.pop_back();
+        }
+        else
+        {
+            release_assert(mEntries.size() <= MAX_ACTORS);
+            handle = Handle(mEntries.size());
+            mEntries.emplace_back();
+        }
+
+        Entry& entry = mEntries[handle];
+        entry.actor = actor;
+        entry.blocking = blocking;
+        setTiles(entry, current, next);
+        link(handle);
+
+        return handle;
+    }
+
+    void ActorGrid::remove(Handle handle)
+    {
+        debug_assert(handle != NO_HANDLE && mEntries[handle].actor);
+
+        unlink(handle);
+        mEntries[handle] = Entry();
+        mFreeHandles.push_back(handle);
+    }
+
+    bool ActorGrid::move(Handle handle, Tile current, Tile next, bool blocking)
+    {
+        Entry& entry = mEntries[handle];
+
+        Entry moved;
+        setTiles(moved, current, next);
+
+        if (blocking == entry.blocking && moved.tileCount == entry.tileCount && std::equal(moved.tiles, moved.tiles + moved.tileCount, entry.tiles))
+            return false;
+
+        unlink(handle);
+        entry.blocking = blocking;
+        setTiles(entry, current, next);
+        link(handle);
+
+        return true;
+    }
+
+    void ActorGrid::getActorsInRadius(Tile centre, int32_t radius, std::vector<Actor*>& actors) const
+    {
+        int32_t minX = std::max(centre.first - radius, 0);
+        int32_t maxX = std::min(centre.first + radius, mWidth - 1);
+        int32_t minY = std::max(centre.second - radius, 0);
+        int32_t maxY = std::min(centre.second + radius, mHeight - 1);
+
+        for (int32_t y = minY; y <= maxY; y++)
+        {
+            int32_t dy = y - centre.second;
+
+            for (int32_t x = minX; x <= maxX; x++)
+            {
+                int32_t dx = x - centre.first;
+                if (dx * dx + dy * dy > radius * radius)
+                    continue;
+
+                for (Link link = mCells[x + y * mWidth]; link != END;)
+                {
+                    const Entry& entry = mEntries[link >> 1];
+
+                    // only the first of an actor's tiles, so nobody is counted twice
+                    if ((link & 1) == 0)
+                        actors.push_back(entry.actor);
+
+                    link = entry.next[link & 1];
+                }
+            }
+        }
+    }
+
+    void ActorGrid::getActorsInRect(Tile min, Tile max, std::vector<Actor*>& actors) const
+    {
+        int32_t minX = std::max(min.first, 0);
+        int32_t maxX = std::min(max.first, mWidth - 1);
+        int32_t minY = std::max(min.second, 0);
+        int32_t maxY = std::min(max.second, mHeight - 1);
+
+        for (int32_t y = minY; y <= maxY; y++)
+        {
+            for (int32_t x = minX; x <= maxX; x++)
+            {
+                for (Link link = mCells[x + y * mWidth]; link != END;)
+                {
+                    const Entry& entry = mEntries[link >> 1];
+
+                    // only the first of an actor's tiles, so an actor walking out of the rectangle is still in it
+                    if ((link & 1) == 0)
+                        actors.push_back(entry.actor);
+
+                    link = entry.next[link & 1];
+                }
+            }
+        }
+    }
+
+    void ActorGrid::setTiles(Entry& entry, Tile current, Tile next) const
+    {
+        entry.tileCount = 0;
+
+        if (inBounds(current))
+            entry.tiles[entry.tileCount++] = current;
+        if (next != current && inBounds(next))
+            entry.tiles[entry.tileCount++] = next;
+    }
+
+    void ActorGrid::link(Handle handle)
+    {
+        Entry& entry = mEntries[handle];
+
+        for (uint8_t i = 0; i < entry.tileCount; i++)
+        {
+            int32_t index = entry.tiles[i].first + entry.tiles[i].second * mWidth;
+
+            entry.next[i] = mCells[index];
+            mCells[index] = Link((handle << 1) | i);
+
+            if (entry.blocking)
+                mBlockingCounts[index]++;
+        }
+    }
+
+    void ActorGrid::unlink(Handle handle)
+    {
+        Entry& entry = mEntries[handle];
+
+        for (uint8_t i = 0; i < entry.tileCount; i++)
+        {
+            Link self = Link((handle << 1) | i);
+            int32_t index = entry.tiles[i].first + entry.tiles[i].second * mWidth;
+
+            if (entry.blocking)
+                mBlockingCounts[index]--;
+
+            // lists are only as long as the number of actors sharing a tile, so finding the one before us is cheap
+            Link* prev = &mCells[index];
+            while (*prev != self)
+            {
+                debug_assert(*prev != END);
+                prev = &mEntries[*prev >> 1].next[*prev & 1];
+            }
+
+            *prev = entry.next[i];
+            entry.next[i] = END;
+        }
+    }
+}
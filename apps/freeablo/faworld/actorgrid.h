@@ -0,0 +1,96 @@
+#ifndef FAWORLD_ACTORGRID_H
+#define FAWORLD_ACTORGRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace FAWorld
+{
+    class Actor;
+
+    ///
+    /// Which actors are on which tiles of a level, as a dense width x height grid of small handles.
+    /// Actors are added once and then moved only when the tiles they're on change, so actors standing still cost nothing
+    /// to keep up to date. Several actors can be on one tile (a monster walking over a corpse), so each tile holds the head
+    /// of a short list threaded through the actors' entries.
+    /// Alongside that it counts the blocking (living) actors on each tile, so isBlocked() is a single read.
+    /// Only the pointers are stored, the grid never looks at the actors themselves.
+    ///
+    class ActorGrid
+    {
+    public:
+        typedef std::pair<int32_t, int32_t> Tile;
+        typedef uint16_t Handle;
+
+        static constexpr Handle NO_HANDLE = 0;
+        static constexpr size_t MAX_ACTORS = 32767;
+
+        ActorGrid() = default;
+        ActorGrid(int32_t width, int32_t height);
+
+        /// An actor can be on two tiles while walking between them, next == current if it's only on one.
+        /// Tiles outside the grid are ignored.
+        Handle add(Actor* actor, Tile current, Tile next, bool blocking);
+        void remove(Handle handle);
+        /// @return false if the actor was already on those tiles, and blocking the same, so nothing had to change
+        bool move(Handle handle, Tile current, Tile next, bool blocking);
+
+        /// If any blocking actor is on the tile, false outside the grid
+        bool isBlocked(int32_t x, int32_t y) const { return inBounds(Tile(x, y)) && mBlockingCounts[x + y * mWidth] != 0; }
+
+        /// Calls func(Actor*) for each actor on the tile, until func returns true
+        template <typename Func> void forEachAt(int32_t x, int32_t y, Func func) const
+        {
+            if (!inBounds(Tile(x, y)))
+                return;
+
+            for (Link link = mCells[x + y * mWidth]; link != END;)
+            {
+                const Entry& entry = mEntries[link >> 1];
+                if (func(entry.actor))
+                    return;
+
+                link = entry.next[link & 1];
+            }
+        }
+
+        /// Appends each actor whose current tile is within radius tiles (straight line distance) of centre
+        void getActorsInRadius(Tile centre, int32_t radius, std::vector<Actor*>& actors) const;
+        /// Appends each actor whose current tile is inside the rectangle from min to max, inclusive
+        void getActorsInRect(Tile min, Tile max, std::vector<Actor*>& actors) const;
+
+        int32_t width() const { return mWidth; }
+        int32_t height() const { return mHeight; }
+        size_t size() const { return mEntries.size() - 1 - mFreeHandles.size(); }
+
+    private:
+        /// (handle << 1) | which of that actor's tiles, so a list can go through both tiles of an actor
+        typedef uint16_t Link;
+        static constexpr Link END = 0;
+
+        struct Entry
+        {
+            Actor* actor = nullptr;
+            Tile tiles[2];
+            uint8_t tileCount = 0; ///< the current tile comes first
+            bool blocking = false;
+            Link next[2] = {END, END};
+        };
+
+        bool inBounds(Tile tile) const { return tile.first >= 0 && tile.first < mWidth && tile.second >= 0 && tile.second < mHeight; }
+        void setTiles(Entry& entry, Tile current, Tile next) const;
+        void link(Handle handle);
+        void unlink(Handle handle);
+
+        int32_t mWidth = 0;
+        int32_t mHeight = 0;
+        std::vector<Link> mCells;
+        std::vector<uint8_t> mBlockingCounts;
+        std::vector<Entry> mEntries = std::vector<Entry>(1); ///< indexed by handle, [NO_HANDLE] is never used
+        std::vector<Handle> mFreeHandles;
+    };
+}
+
+#endif
@@ -3,6 +3,7 @@
 #include "../fasavegame/gameloader.h"
 #include "actor.h"
 #include "player.h"
+#include "simstats.h"
 #include <cstdlib>
 #include <iostream>
 #include <misc/assert.h>
@@ -48,6 +49,8 @@ namespace FAWorld
 
     void BasicMonsterBehaviour::update()
     {
+        Misc::TimeCounter::Scope counter(SimStats::behaviour);
+
         mTicksSinceLastAction++;
 
         if (!mActor->isDead())
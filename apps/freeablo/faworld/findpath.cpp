@@ -1,178 +1,403 @@
 #include "findpath.h"
 #include "gamelevel.h"
-#include <misc/stdhashes.h>
+#include "simstats.h"
+#include <misc/profiler.h>
 
 namespace FAWorld
 {
-    template <typename T, typename Number = size_t> struct PriorityQueue
+    typedef PathFinder::Location Location;
+
+    constexpr int32_t PathFinder::MAX_EXPANDED;
+    constexpr int32_t PathFinder::MAX_SCANNED;
+
+    // Jump point search costs, a diagonal step is about sqrt(2) straight ones
+    static constexpr int32_t STRAIGHT_COST = 10;
+    static constexpr int32_t DIAGONAL_COST = 14;
+
+    static int32_t sign(int32_t value) { return (value > 0) - (value < 0); }
+
+    static int32_t heuristic(Location a, Location b)
+    {
+        int32_t dx = abs(b.first - a.first);
+        int32_t dy = abs(b.second - a.second);
+
+        return dx + dy;
+    }
+
+    static int32_t octileDistance(Location a, Location b)
     {
-        typedef std::pair<Number, T> PQElement;
-        std::priority_queue<PQElement, std::vector<PQElement>, std::greater<PQElement>> elements;
+        int32_t dx = abs(b.first - a.first);
+        int32_t dy = abs(b.second - a.second);
 
-        inline bool empty() { return elements.empty(); }
+        return STRAIGHT_COST * std::max(dx, dy) + (DIAGONAL_COST - STRAIGHT_COST) * std::min(dx, dy);
+    }
 
-        inline void put(T item, Number priority) { elements.emplace(priority, item); }
+    void PathFinder::find(
+        GameLevelImpl* level, Location start, Location& goal, bool& bArrivable, bool findAdjacent, std::vector<Location>& path, PathAlgorithm algorithm)
+    {
+        path.clear();
+        bArrivable = false;
+        mExpanded = 0;
+        mScanned = 0;
 
-        inline T get()
+        if (startSearch(level, start, goal, findAdjacent))
         {
-            T best_item = elements.top().second;
-            elements.pop();
-            return best_item;
+            if (algorithm == PathAlgorithm::JumpPoint)
+                bArrivable = searchJumpPoint(goal);
+            else
+                bArrivable = searchAStar(goal);
         }
-    };
 
-    typedef std::pair<int32_t, int32_t> Location;
+        if (bArrivable)
+            reconstructPath(start.first + start.second * mWidth, goal.first + goal.second * mWidth, path);
 
-    bool inBounds(GameLevelImpl* level, Location location)
-    {
-        int x = location.first;
-        int y = location.second;
-        return 0 <= x && x < (int)level->width() && 0 <= y && y < (int)level->height();
+        mLevel = nullptr;
     }
 
-    std::vector<Location> neighbors(GameLevelImpl* level, Location location)
+    bool PathFinder::startSearch(GameLevelImpl* level, Location start, Location goal, bool findAdjacent)
     {
-        int x = location.first;
-        int y = location.second;
+        mLevel = level;
+        mWidth = level->width();
+        mHeight = level->height();
+        mGoal = goal;
+        mStopNextToGoal = findAdjacent || !level->isPassable(goal.first, goal.second);
+
+        mHeap.clear();
+
+        if (start.first < 0 || start.first >= mWidth || start.second < 0 || start.second >= mHeight)
+            return false;
 
-        std::vector<Location> results(0);
-        results.reserve(9);
+        // Only ever grows, so moving between levels of different sizes doesn't reallocate either
+        if (mNodes.size() < size_t(mWidth * mHeight))
+            mNodes.resize(mWidth * mHeight);
 
-        for (int32_t dy = -1; dy <= 1; dy++)
+        // Nodes stamped with an old search are as good as unvisited, so only wrapping around needs them cleared
+        if (++mSearch == 0)
         {
-            for (int32_t dx = -1; dx <= 1; dx++)
-            {
-                Location next(x + dx, y + dy);
-                if (inBounds(level, next) && level->isPassable(next.first, next.second))
-                    results.push_back(next);
-            }
+            for (Node& node : mNodes)
+                node.search = 0;
+            mSearch = 1;
         }
 
-        return results;
+        int32_t startIndex = start.first + start.second * mWidth;
+        addToOpen(startIndex, startIndex, 0, 0);
+
+        return true;
     }
 
-    int heuristic(Location a, Location b)
+    bool PathFinder::isTarget(int32_t x, int32_t y) const
     {
-        int dx = abs(b.first - a.first);
-        int dy = abs(b.second - a.second);
+        if (mStopNextToGoal)
+            return abs(mGoal.first - x) <= 1 && abs(mGoal.second - y) <= 1;
 
-        return dx + dy;
+        return x == mGoal.first && y == mGoal.second;
     }
 
-    template <typename T> class Array2D
+    bool PathFinder::isPassable(int32_t x, int32_t y) const { return x >= 0 && x < mWidth && y >= 0 && y < mHeight && mLevel->isPassable(x, y); }
+
+    void PathFinder::addToOpen(int32_t index, int32_t fromIndex, int32_t cost, int32_t priority)
     {
-    public:
-        Array2D(int32_t width, int32_t height) : mData(width * height), mWidth(width), mHeight(height) {}
+        Node& node = mNodes[index];
+        bool queued = node.search == mSearch && node.heapIndex != -1;
+
+        node.search = mSearch;
+        node.cost = cost;
+        node.priority = priority;
+        node.cameFrom = fromIndex;
+
+        // The heuristic can overestimate, so a tile already expanded can still turn up again with a cheaper route
+        if (queued)
+            heapUp(node.heapIndex);
+        else
+            heapPush(index);
+    }
 
-        Array2D(int32_t width, int32_t height, T defaultVal) : mData(width * height, defaultVal), mWidth(width), mHeight(height) {}
+    bool PathFinder::searchAStar(Location& goal)
+    {
+        while (!mHeap.empty() && mExpanded < MAX_EXPANDED)
+        {
+            mExpanded++;
 
-        T& get(int32_t x, int32_t y) { return mData.at(x + y * mHeight); }
+            int32_t currentIndex = heapPop();
+            Location current(currentIndex % mWidth, currentIndex / mWidth);
 
-        int32_t width() { return mWidth; }
+            if (isTarget(current.first, current.second))
+            {
+                goal = current;
+                return true;
+            }
 
-        int32_t height() { return mHeight; }
+            int32_t newCost = mNodes[currentIndex].cost + 1;
 
-    private:
-        std::vector<T> mData;
-        int32_t mWidth;
-        int32_t mHeight;
-    };
+            for (int32_t dy = -1; dy <= 1; dy++)
+            {
+                for (int32_t dx = -1; dx <= 1; dx++)
+                {
+                    Location next(current.first + dx, current.second + dy);
 
-    bool AStarSearch(GameLevelImpl* level, Location start, Location& goal, std::unordered_map<Location, Location>& came_from, bool findAdjacent)
-    {
-        auto goalPassable = level->isPassable(goal.first, goal.second);
-        PriorityQueue<Location> frontier;
-        frontier.put(start, 0);
-        came_from[start] = start;
+                    if ((dx == 0 && dy == 0) || !isPassable(next.first, next.second))
+                        continue;
 
-        Array2D<int32_t> costSoFar(level->width(), level->height(), -1);
-        costSoFar.get(start.first, start.second) = 0;
+                    int32_t nextIndex = next.first + next.second * mWidth;
+                    const Node& node = mNodes[nextIndex];
 
-        int32_t iterations = 0;
-        while (!frontier.empty() && iterations < 500)
+                    if (node.search != mSearch || newCost < node.cost)
+                        addToOpen(nextIndex, currentIndex, newCost, newCost + heuristic(next, mGoal));
+                }
+            }
+        }
+
+        return false;
+    }
+
+    bool PathFinder::searchJumpPoint(Location& goal)
+    {
+        // Each expansion can scan a long way, so the tiles scanned have a budget of their own, or one search for an unreachable
+        // goal could step over most of the level
+        while (!mHeap.empty() && mExpanded < MAX_EXPANDED && mScanned < MAX_SCANNED)
         {
-            iterations++;
-            Location current = frontier.get();
+            mExpanded++;
+
+            int32_t currentIndex = heapPop();
+            Location current(currentIndex % mWidth, currentIndex / mWidth);
 
-            // Early exit
-            if (current == goal)
+            if (isTarget(current.first, current.second))
+            {
+                goal = current;
                 return true;
-            if (findAdjacent || !goalPassable)
+            }
+
+            const int32_t x = current.first;
+            const int32_t y = current.second;
+
+            // The directions a shortest path through here could carry on in: all of them from the start, otherwise straight on,
+            // plus wherever a wall next to us means the only shortest way round goes through this tile (the "forced" neighbours)
+            Location directions[8];
+            int32_t directionCount = 0;
+
+            int32_t fromIndex = mNodes[currentIndex].cameFrom;
+            int32_t dx = sign(x - fromIndex % mWidth);
+            int32_t dy = sign(y - fromIndex / mWidth);
+
+            if (dx == 0 && dy == 0)
             {
-                if (abs(goal.first - current.first) <= 1 && abs(goal.second - current.second) <= 1)
+                for (int32_t ny = -1; ny <= 1; ny++)
                 {
-                    goal = current;
-                    return true;
+                    for (int32_t nx = -1; nx <= 1; nx++)
+                    {
+                        if (nx != 0 || ny != 0)
+                            directions[directionCount++] = Location(nx, ny);
+                    }
                 }
             }
-
-            std::vector<Location> neighborsContainer = neighbors(level, current);
-            for (std::vector<Location>::iterator it = neighborsContainer.begin(); it != neighborsContainer.end(); it++)
+            else if (dx != 0 && dy != 0)
+            {
+                directions[directionCount++] = Location(dx, dy);
+                directions[directionCount++] = Location(dx, 0);
+                directions[directionCount++] = Location(0, dy);
+                if (!isPassable(x - dx, y))
+                    directions[directionCount++] = Location(-dx, dy);
+                if (!isPassable(x, y - dy))
+                    directions[directionCount++] = Location(dx, -dy);
+            }
+            else if (dx != 0)
+            {
+                directions[directionCount++] = Location(dx, 0);
+                if (!isPassable(x, y + 1))
+                    directions[directionCount++] = Location(dx, 1);
+                if (!isPassable(x, y - 1))
+                    directions[directionCount++] = Location(dx, -1);
+            }
+            else
             {
-                int32_t new_cost = costSoFar.get(current.first, current.second) + 1; // graph.cost(current, next);
-                Location next = *it;
+                directions[directionCount++] = Location(0, dy);
+                if (!isPassable(x + 1, y))
+                    directions[directionCount++] = Location(1, dy);
+                if (!isPassable(x - 1, y))
+                    directions[directionCount++] = Location(-1, dy);
+            }
 
-                if (costSoFar.get(next.first, next.second) == -1 || new_cost < costSoFar.get(next.first, next.second))
-                {
-                    costSoFar.get(next.first, next.second) = new_cost;
-                    int32_t priority = new_cost + heuristic(next, goal);
-                    frontier.put(next, priority);
-                    came_from[next] = current;
-                }
+            for (int32_t i = 0; i < directionCount; i++)
+            {
+                int32_t jumpX = x;
+                int32_t jumpY = y;
+                if (!jump(jumpX, jumpY, directions[i].first, directions[i].second))
+                    continue;
+
+                Location next(jumpX, jumpY);
+                int32_t nextIndex = jumpX + jumpY * mWidth;
+                int32_t newCost = mNodes[currentIndex].cost + octileDistance(current, next);
+                const Node& node = mNodes[nextIndex];
+
+                if (node.search != mSearch || newCost < node.cost)
+                    addToOpen(nextIndex, currentIndex, newCost, newCost + octileDistance(next, mGoal));
             }
         }
 
         return false;
     }
 
-    std::vector<Location> reconstructPath(Location start, Location goal, std::unordered_map<Location, Location>& cameFrom)
+    /// Steps from (x, y) in direction (dx, dy) until it finds somewhere the path might turn, and leaves (x, y) there.
+    /// Going diagonally, that includes anywhere a straight jump from the tile would find something.
+    /// @return false if it ran into a wall first, or used up the rest of MAX_SCANNED
+    bool PathFinder::jump(int32_t& x, int32_t& y, int32_t dx, int32_t dy)
     {
-        std::vector<Location> path;
-        Location current = goal;
-        path.push_back(current);
-        while (current != start)
+        while (true)
+        {
+            if (mScanned == MAX_SCANNED)
+                return false;
+            mScanned++;
+
+            x += dx;
+            y += dy;
+
+            if (!isPassable(x, y))
+                return false;
+            if (isTarget(x, y))
+                return true;
+
+            if (dx != 0 && dy != 0)
+            {
+                if ((!isPassable(x - dx, y) && isPassable(x - dx, y + dy)) || (!isPassable(x, y - dy) && isPassable(x + dx, y - dy)))
+                    return true;
+
+                int32_t straightX = x;
+                int32_t straightY = y;
+                if (jump(straightX, straightY, dx, 0))
+                    return true;
+
+                straightX = x;
+                straightY = y;
+                if (jump(straightX, straightY, 0, dy))
+                    return true;
+            }
+            else if (dx != 0)
+            {
+                if ((!isPassable(x, y + 1) && isPassable(x + dx, y + 1)) || (!isPassable(x, y - 1) && isPassable(x + dx, y - 1)))
+                    return true;
+            }
+            else
+            {
+                if ((!isPassable(x + 1, y) && isPassable(x + 1, y + dy)) || (!isPassable(x - 1, y) && isPassable(x - 1, y + dy)))
+                    return true;
+            }
+        }
+    }
+
+    void PathFinder::reconstructPath(int32_t startIndex, int32_t goalIndex, std::vector<Location>& path) const
+    {
+        if (goalIndex == startIndex)
+            path.push_back(Location(goalIndex % mWidth, goalIndex / mWidth));
+
+        // Jump point search only links up the tiles where the path turns, so fill in the straight or diagonal lines between them
+        for (int32_t index = goalIndex; index != startIndex; index = mNodes[index].cameFrom)
         {
-            current = cameFrom[current];
-            if (current != start)
-                path.push_back(current);
+            Location tile(index % mWidth, index / mWidth);
+            Location from(mNodes[index].cameFrom % mWidth, mNodes[index].cameFrom / mWidth);
+
+            int32_t dx = sign(from.first - tile.first);
+            int32_t dy = sign(from.second - tile.second);
+
+            for (; tile != from; tile.first += dx, tile.second += dy)
+                path.push_back(tile);
         }
+
         std::reverse(path.begin(), path.end());
-        return path;
     }
 
-    Location findClosesPointToGoal(GameLevelImpl* level, Location start, Location goal, std::unordered_map<Location, Location>& cameFrom)
+    bool PathFinder::heapLess(int32_t a, int32_t b) const
     {
-        // int dx = abs(goal.first - start.first);
-        // int dy = abs(goal.second - start.second);
-        UNUSED_PARAM(start);
-        int minDistance = level->width() * level->width() + level->height() * level->height();
+        const Node& nodeA = mNodes[a];
+        const Node& nodeB = mNodes[b];
+
+        if (nodeA.priority != nodeB.priority)
+            return nodeA.priority < nodeB.priority;
 
-        Location result(-1, -1);
+        // Keeps the order the same between runs and machines
+        return a < b;
+    }
 
-        for (std::unordered_map<Location, Location>::iterator it = cameFrom.begin(); it != cameFrom.end(); it++)
+    void PathFinder::heapPush(int32_t index)
+    {
+        mNodes[index].heapIndex = int32_t(mHeap.size());
+        mHeap.push_back(index);
+        heapUp(int32_t(mHeap.size()) - 1);
+    }
+
+    int32_t PathFinder::heapPop()
+    {
+        int32_t top = mHeap[0];
+
+        mHeap[0] = mHeap.back();
+        mNodes[mHeap[0]].heapIndex = 0;
+        mHeap.pop_back();
+
+        if (!mHeap.empty())
+            heapDown(0);
+
+        mNodes[top].heapIndex = -1;
+        return top;
+    }
+
+    void PathFinder::heapUp(int32_t position)
+    {
+        int32_t index = mHeap[position];
+
+        while (position > 0)
         {
-            int tmpX = abs(it->first.first - goal.first);
-            int tmpY = abs(it->first.second - goal.second);
+            int32_t parent = (position - 1) / 2;
+            if (!heapLess(index, mHeap[parent]))
+                break;
 
-            int distance = tmpX * tmpX + tmpY * tmpY;
-            if (distance < minDistance)
-            {
-                minDistance = distance;
-                result = it->first;
-            }
+            mHeap[position] = mHeap[parent];
+            mNodes[mHeap[position]].heapIndex = position;
+            position = parent;
         }
 
-        return result;
+        mHeap[position] = index;
+        mNodes[index].heapIndex = position;
     }
 
-    std::vector<Location> pathFind(GameLevelImpl* level, Location start, Location& goal, bool& bArrivable, bool findAdjacent)
+    void PathFinder::heapDown(int32_t position)
     {
-        std::unordered_map<Location, Location> cameFrom;
+        int32_t index = mHeap[position];
+        int32_t size = int32_t(mHeap.size());
 
-        bArrivable = AStarSearch(level, start, goal, cameFrom, findAdjacent);
-        if (!bArrivable)
-            return {};
+        while (true)
+        {
+            int32_t child = position * 2 + 1;
+            if (child >= size)
+                break;
+
+            if (child + 1 < size && heapLess(mHeap[child + 1], mHeap[child]))
+                child++;
+
+            if (!heapLess(mHeap[child], index))
+                break;
+
+            mHeap[position] = mHeap[child];
+            mNodes[mHeap[position]].heapIndex = position;
+            position = child;
+        }
+
+        mHeap[position] = index;
+        mNodes[index].heapIndex = position;
+    }
+
+    std::vector<Location> pathFind(GameLevelImpl* level, Location start, Location& goal, bool& bArrivable, bool findAdjacent, PathAlgorithm algorithm)
+    {
+        std::vector<Location> path;
+        pathFind(level, start, goal, bArrivable, findAdjacent, path, algorithm);
+        return path;
+    }
+
+    void pathFind(
+        GameLevelImpl* level, Location start, Location& goal, bool& bArrivable, bool findAdjacent, std::vector<Location>& path, PathAlgorithm algorithm)
+    {
+        FA_PROFILE_ZONE("pathFind");
+        Misc::TimeCounter::Scope counter(SimStats::pathFinding);
 
-        return reconstructPath(start, goal, cameFrom);
+        static thread_local PathFinder pathFinder;
+        pathFinder.find(level, start, goal, bArrivable, findAdjacent, path, algorithm);
     }
 }
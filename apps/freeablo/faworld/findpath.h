@@ -18,7 +18,100 @@
 namespace FAWorld
 {
     class GameLevelImpl;
-    std::vector<std::pair<int32_t, int32_t>>
-    pathFind(GameLevelImpl* level, std::pair<int32_t, int32_t> start, std::pair<int32_t, int32_t>& goal, bool& bArrivable, bool findAdjacent);
+
+    enum class PathAlgorithm
+    {
+        AStar,    ///< looks at every neighbour, with a Manhattan heuristic and every step costing the same
+        JumpPoint ///< jump point search, with diagonal steps costing more and an octile heuristic, so it finds the shortest path,
+                  ///< and as it only expands tiles where the path could turn, it reaches much further for the same MAX_EXPANDED
+    };
+
+    ///
+    /// A* over a level's tiles, eight neighbours each, that keeps everything it needs between searches.
+    /// Per tile state is in a flat array indexed x + y * width and stamped with the search that wrote it, so a new search only
+    /// bumps the stamp rather than clearing every tile. The open list is a binary heap of tile indices where each tile knows its
+    /// place in the heap, so finding a cheaper route to a queued tile moves it up in place instead of queueing it twice.
+    /// Once the arrays have grown to fit the biggest level searched, a search allocates nothing.
+    /// Which neighbours it looks at and what a step costs is up to the PathAlgorithm given to each search.
+    ///
+    class PathFinder
+    {
+    public:
+        typedef std::pair<int32_t, int32_t> Location;
+
+        static constexpr int32_t MAX_EXPANDED = 500;              ///< tiles a search looks at before giving up
+        static constexpr int32_t MAX_SCANNED = MAX_EXPANDED * 8; ///< tiles jump point search can step over, about as many as A* looks at in MAX_EXPANDED
+
+        /// Fills path with the tiles to walk through to goal, not including start. It's left empty and bArrivable false if goal
+        /// can't be reached. If findAdjacent, or goal itself isn't passable, any tile next to goal will do, and goal is set to it.
+        void find(GameLevelImpl* level,
+                  Location start,
+                  Location& goal,
+                  bool& bArrivable,
+                  bool findAdjacent,
+                  std::vector<Location>& path,
+                  PathAlgorithm algorithm = PathAlgorithm::AStar);
+
+        /// Tiles taken off the open list by the last search
+        int32_t expanded() const { return mExpanded; }
+        /// Tiles the last jump point search stepped over looking for somewhere to stop
+        int32_t scanned() const { return mScanned; }
+
+    private:
+        struct Node
+        {
+            uint32_t search = 0; ///< the rest is only valid if this is the current search
+            int32_t cost;
+            int32_t priority;
+            int32_t cameFrom;
+            int32_t heapIndex; ///< -1 once taken off the open list
+        };
+
+        bool startSearch(GameLevelImpl* level, Location start, Location goal, bool findAdjacent);
+        bool isTarget(int32_t x, int32_t y) const;
+        bool isPassable(int32_t x, int32_t y) const;
+        void addToOpen(int32_t index, int32_t fromIndex, int32_t cost, int32_t priority);
+
+        bool searchAStar(Location& goal);
+        bool searchJumpPoint(Location& goal);
+        bool jump(int32_t& x, int32_t& y, int32_t dx, int32_t dy);
+
+        void reconstructPath(int32_t startIndex, int32_t goalIndex, std::vector<Location>& path) const;
+
+        bool heapLess(int32_t a, int32_t b) const;
+        void heapPush(int32_t index);
+        int32_t heapPop();
+        void heapUp(int32_t position);
+        void heapDown(int32_t position);
+
+        std::vector<Node> mNodes;
+        std::vector<int32_t> mHeap;
+        uint32_t mSearch = 0;
+        int32_t mExpanded = 0;
+        int32_t mScanned = 0;
+
+        // the search in progress
+        GameLevelImpl* mLevel = nullptr;
+        int32_t mWidth = 0;
+        int32_t mHeight = 0;
+        Location mGoal;
+        bool mStopNextToGoal = false;
+    };
+
+    /// Searches with a PathFinder kept per thread, see PathFinder::find()
+    std::vector<std::pair<int32_t, int32_t>> pathFind(GameLevelImpl* level,
+                                                      std::pair<int32_t, int32_t> start,
+                                                      std::pair<int32_t, int32_t>& goal,
+                                                      bool& bArrivable,
+                                                      bool findAdjacent,
+                                                      PathAlgorithm algorithm = PathAlgorithm::AStar);
+    /// As above, but reuses path's storage
+    void pathFind(GameLevelImpl* level,
+                  std::pair<int32_t, int32_t> start,
+                  std::pair<int32_t, int32_t>& goal,
+                  bool& bArrivable,
+                  bool findAdjacent,
+                  std::vector<std::pair<int32_t, int32_t>>& path,
+                  PathAlgorithm algorithm = PathAlgorithm::AStar);
 }
 #endif /* COMPONENTS_LEVEL_PATHFINDING_H_ */
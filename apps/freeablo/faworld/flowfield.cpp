@@ -0,0 +1,7 @@
+#include "flowfield.h"
+
+namespace FAWorld
+{
+    constexpr int32_t FlowField::MAX_DISTANCE;
+    constexpr uint8_t FlowField::UNREACHABLE;
+}
@@ -0,0 +1,140 @@
+#ifndef FAWORLD_FLOWFIELD_H
+#define FAWORLD_FLOWFIELD_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace FAWorld
+{
+    ///
+    /// How many steps each tile within MAX_DISTANCE of a target tile is from it, eight neighbours to a tile, found with one
+    /// breadth first search. Everything chasing the same target reads its next step from here instead of each running pathFind().
+    /// Only walls count, actors would change it every tick, so a chaser checks the tile it's stepping to is free as it steps.
+    ///
+    class FlowField
+    {
+    public:
+        typedef std::pair<int32_t, int32_t> Tile;
+
+        static constexpr int32_t MAX_DISTANCE = 30;
+        static constexpr uint8_t UNREACHABLE = 0xff;
+
+        /// Searches out from target again, unless that's where it searched from last time.
+        /// isPassable(x, y) is only asked about tiles inside width x height.
+        /// @return true if it had to search
+        template <typename IsPassable> bool update(int32_t width, int32_t height, Tile target, IsPassable isPassable);
+
+        const Tile& target() const { return mTarget; }
+
+        /// Steps from (x, y) to the target, UNREACHABLE if it's further than MAX_DISTANCE or walled off
+        uint8_t distance(int32_t x, int32_t y) const
+        {
+            return x >= 0 && x < mWidth && y >= 0 && y < mHeight ? mDistances[x + y * mWidth] : UNREACHABLE;
+        }
+
+        /// The neighbour of from a step closer to the target, of the ones isPassable(x, y) says are free. Of equally close ones, the
+        /// one nearest the target in a straight line. False if there isn't one, because from is next to the target or the way is blocked.
+        template <typename IsPassable> bool nextStep(Tile from, Tile& next, IsPassable isPassable) const;
+
+    private:
+        int32_t mWidth = 0;
+        int32_t mHeight = 0;
+        Tile mTarget = Tile(-1, -1);
+        std::vector<uint8_t> mDistances;
+        std::vector<int32_t> mReached; ///< tiles the last search set, so the next one only has to reset those
+    };
+
+    template <typename IsPassable> bool FlowField::update(int32_t width, int32_t height, Tile target, IsPassable isPassable)
+    {
+        if (target == mTarget && width == mWidth && height == mHeight)
+            return false;
+
+        if (width != mWidth || height != mHeight)
+        {
+            mWidth = width;
+            mHeight = height;
+            mDistances.assign(width * height, UNREACHABLE);
+            mReached.clear();
+        }
+
+        for (int32_t index : mReached)
+            mDistances[index] = UNREACHABLE;
+        mReached.clear();
+
+        mTarget = target;
+        if (target.first < 0 || target.first >= mWidth || target.second < 0 || target.second >= mHeight)
+            return true;
+
+        // mReached doubles as the queue, tiles are added in order of distance
+        mDistances[target.first + target.second * mWidth] = 0;
+        mReached.push_back(target.first + target.second * mWidth);
+
+        for (size_t i = 0; i < mReached.size(); i++)
+        {
+            int32_t index = mReached[i];
+            uint8_t nextDistance = mDistances[index] + 1;
+            if (nextDistance > MAX_DISTANCE)
+                break;
+
+            int32_t x = index % mWidth;
+            int32_t y = index / mWidth;
+
+            for (int32_t dy = -1; dy <= 1; dy++)
+            {
+                for (int32_t dx = -1; dx <= 1; dx++)
+                {
+                    int32_t nx = x + dx;
+                    int32_t ny = y + dy;
+
+                    if (nx < 0 || nx >= mWidth || ny < 0 || ny >= mHeight || mDistances[nx + ny * mWidth] != UNREACHABLE || !isPassable(nx, ny))
+                        continue;
+
+                    mDistances[nx + ny * mWidth] = nextDistance;
+                    mReached.push_back(nx + ny * mWidth);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    template <typename IsPassable> bool FlowField::nextStep(Tile from, Tile& next, IsPassable isPassable) const
+    {
+        uint8_t bestDistance = distance(from.first, from.second);
+        int32_t bestStraightLine = 0;
+        bool found = false;
+
+        if (bestDistance == UNREACHABLE || bestDistance <= 1)
+            return false;
+
+        for (int32_t dy = -1; dy <= 1; dy++)
+        {
+            for (int32_t dx = -1; dx <= 1; dx++)
+            {
+                Tile tile(from.first + dx, from.second + dy);
+                uint8_t tileDistance = distance(tile.first, tile.second);
+
+                if (tileDistance >= bestDistance + (found ? 1 : 0) || !isPassable(tile.first, tile.second))
+                    continue;
+
+                int32_t straightX = tile.first - mTarget.first;
+                int32_t straightY = tile.second - mTarget.second;
+                int32_t straightLine = straightX * straightX + straightY * straightY;
+
+                if (!found || tileDistance < bestDistance || straightLine < bestStraightLine)
+                {
+                    found = true;
+                    next = tile;
+                    bestDistance = tileDistance;
+                    bestStraightLine = straightLine;
+                }
+            }
+        }
+
+        return found;
+    }
+}
+
+#endif
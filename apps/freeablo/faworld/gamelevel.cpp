@@ -3,16 +3,34 @@
 #include "actor.h"
 #include "actorstats.h"
 #include "itemmap.h"
+#include "simstats.h"
 #include "world.h"
+#include <algorithm>
 #include <diabloexe/diabloexe.h>
 #include <misc/assert.h>
+#include <misc/profiler.h>
 
 namespace FAWorld
 {
-    GameLevel::GameLevel(Level::Level level, size_t levelIndex) : mLevel(level), mLevelIndex(levelIndex), mItemMap(new ItemMap(this)) {}
+    // The tiles an actor is on: the one it's on, and the one it's walking to once it has started towards it.
+    // An actor that has just arrived still counts as moving until its next update, but is only on its new tile.
+    static void occupiedTiles(const Actor* actor, ActorGrid::Tile& current, ActorGrid::Tile& next, bool& blocking)
+    {
+        const Position& pos = actor->getPos();
+
+        current = pos.current();
+        next = pos.isMoving() && pos.getDist() > 0 ? pos.next() : current;
+        blocking = !actor->isPassable();
+    }
+
+    GameLevel::GameLevel(Level::Level level, size_t levelIndex)
+        : mLevel(level), mLevelIndex(levelIndex), mActorGrid(mLevel.width(), mLevel.height()), mItemMap(new ItemMap(this))
+    {
+    }
 
     GameLevel::GameLevel(FASaveGame::GameLoader& loader)
-        : mLevel(Level::Level(loader)), mLevelIndex(loader.load<int32_t>()), mItemMap(new ItemMap(loader, this))
+        : mLevel(Level::Level(loader)), mLevelIndex(loader.load<int32_t>()), mActorGrid(mLevel.width(), mLevel.height()),
+          mItemMap(new ItemMap(loader, this))
     {
         uint32_t actorsSize = loader.load<uint32_t>();
 
@@ -21,8 +39,19 @@ namespace FAWorld
         {
             std::string actorTypeId = loader.load<std::string>();
             Actor* actor = static_cast<Actor*>(World::get()->mObjectIdMapper.construct(actorTypeId, loader));
+
+            ActorGrid::Tile current, next;
+            bool blocking;
+            occupiedTiles(actor, current, next, blocking);
+
             mActors.push_back(actor);
+            mActorHandles.push_back(mActorGrid.add(actor, current, next, blocking));
         }
+
+        // Only who has a flow field is saved, the fields themselves are filled in again at the start of the next update()
+        uint32_t flowFieldsSize = loader.load<uint32_t>();
+        for (uint32_t i = 0; i < flowFieldsSize; i++)
+            mFlowFields.emplace_back(loader.load<int32_t>(), FlowField());
     }
 
     void GameLevel::save(FASaveGame::GameSaver& saver)
@@ -41,6 +70,11 @@ namespace FAWorld
             saver.save(actor->getTypeId());
             actor->save(saver);
         }
+
+        uint32_t flowFieldsSize = mFlowFields.size();
+        saver.save(flowFieldsSize);
+        for (const auto& flowField : mFlowFields)
+            saver.save(flowField.first);
     }
 
     GameLevel::~GameLevel()
@@ -67,117 +101,166 @@ namespace FAWorld
 
     void GameLevel::update(bool noclip)
     {
+        FA_PROFILE_ZONE("GameLevel::update");
+
+        // Flow fields are only filled in here, before anyone moves, so a chaser's step doesn't depend on whether someone else asked
+        // for the field first. removeActor() drops the field of anyone leaving, but a loaded save could still name someone who
+        // isn't here, so a missing target drops the field too.
+        for (size_t i = 0; i < mFlowFields.size();)
+        {
+            const Actor* target = getActorById(mFlowFields[i].first);
+            if (!target)
+            {
+                mFlowFields.erase(mFlowFields.begin() + i);
+                continue;
+            }
+
+            updateFlowField(mFlowFields[i].second, target);
+            i++;
+        }
+
         for (size_t i = 0; i < mActors.size(); i++)
         {
             Actor* actor = mActors[i];
-
-            actorMapRemove(actor);
             actor->update(noclip);
-            actorMapInsert(actor);
-        }
 
-        actorMapRefresh();
+            // unless it left the level during its update. Actors killed by one that comes later stay blocking until next tick
+            if (i < mActors.size() && mActors[i] == actor)
+            {
+                Misc::TimeCounter::Scope counter(SimStats::actorMap);
+                actorGridMove(i);
+            }
+        }
 
         for (auto& p : mItemMap->mItems)
             p.second.update();
     }
 
-    void GameLevel::actorMapInsert(Actor* actor)
+    void GameLevel::actorGridMove(size_t actorIndex)
     {
-        mActorMap2D[actor->getPos().current()] = actor;
-        if (actor->getPos().isMoving())
-            mActorMap2D[actor->getPos().next()] = actor;
+        ActorGrid::Tile current, next;
+        bool blocking;
+        occupiedTiles(mActors[actorIndex], current, next, blocking);
+        mActorGrid.move(mActorHandles[actorIndex], current, next, blocking);
     }
 
-    void GameLevel::actorMapRemove(Actor* actor)
+    bool GameLevel::isPassable(int x, int y) const
     {
-        if (mActorMap2D[actor->getPos().current()] == actor)
-            mActorMap2D.erase(actor->getPos().current());
-        if (actor->getPos().isMoving() && mActorMap2D[actor->getPos().next()] == actor)
-            mActorMap2D.erase(actor->getPos().next());
+        return mLevel.isPassable(x, y) && !mActorGrid.isBlocked(x, y);
     }
 
-    void GameLevel::actorMapClear() { mActorMap2D.clear(); }
+    Actor* GameLevel::getActorAt(int32_t x, int32_t y) const
+    {
+        Actor* found = nullptr;
+        mActorGrid.forEachAt(x, y, [&found](Actor* actor) {
+            if (!found || !actor->isDead())
+                found = actor;
+            return !found->isDead();
+        });
+
+        return found;
+    }
 
-    void GameLevel::actorMapRefresh()
+    void GameLevel::getActorsInRadius(std::pair<int32_t, int32_t> centre, int32_t radius, std::vector<Actor*>& actors) const
     {
-        actorMapClear();
-        for (size_t i = 0; i < mActors.size(); i++)
-            actorMapInsert(mActors[i]);
+        mActorGrid.getActorsInRadius(centre, radius, actors);
     }
 
-    bool GameLevel::isPassable(int x, int y) const
+    void GameLevel::addActor(Actor* actor)
     {
-        if (x > 0 && x < width() && y > 0 && y < height() && !mLevel[x][y].passable())
-            return false;
+        ActorGrid::Tile current, next;
+        bool blocking;
+        occupiedTiles(actor, current, next, blocking);
 
-        FAWorld::Actor* actor = getActorAt(x, y);
-        return actor == NULL || actor->isPassable();
+        mActors.push_back(actor);
+        mActorHandles.push_back(mActorGrid.add(actor, current, next, blocking));
     }
 
-    Actor* GameLevel::getActorAt(int32_t x, int32_t y) const
+    const FlowField* GameLevel::getFlowField(int32_t targetId)
     {
-        auto it = mActorMap2D.find(std::pair<int32_t, int32_t>(x, y));
-        if (it == mActorMap2D.end())
+        for (auto& flowField : mFlowFields)
+        {
+            if (flowField.first == targetId)
+                return &flowField.second;
+        }
+
+        if (!getActorById(targetId))
             return nullptr;
 
-        return it->second;
+        // Filling it in now would use where the target is partway through the tick, see update()
+        mFlowFields.emplace_back(targetId, FlowField());
+        return &mFlowFields.back().second;
     }
 
-    void GameLevel::addActor(Actor* actor)
+    void GameLevel::updateFlowField(FlowField& field, const Actor* target)
     {
-        mActors.push_back(actor);
-        actorMapInsert(actor);
+        Misc::TimeCounter::Scope counter(SimStats::flowFields);
+        field.update(width(), height(), target->getPos().current(), [this](int32_t x, int32_t y) { return mLevel.isPassable(x, y); });
     }
 
     static Cel::Colour friendHoverColor() { return {180, 110, 110, true}; }
     static Cel::Colour enemyHoverColor() { return {164, 46, 46, true}; }
     static Cel::Colour itemHoverColor() { return {185, 170, 119, true}; }
 
-    void GameLevel::fillRenderState(FARender::RenderState* state, Actor* displayedActor)
+    void GameLevel::getRenderablesInRect(const Misc::TileRect& rect, std::vector<Actor*>& actors, std::vector<PlacedItemData*>& items)
     {
-        state->mObjects.clear();
-        state->mItems.clear();
+        // by their current tile, the one they're drawn on while moving, see Render::drawLevel
+        mActorGrid.getActorsInRect({rect.minX, rect.minY}, {rect.maxX, rect.maxY}, actors);
 
-        for (size_t i = 0; i < mActors.size(); i++)
+        mItemMap->getItemsInRect(rect, items);
+    }
+
+    void GameLevel::fillRenderState(FARender::RenderState* state, Actor* displayedActor, const Misc::TileRect& visibleTiles)
+    {
+        state->clearObjects(width(), height());
+
+        mVisibleActors.clear();
+        mVisibleItems.clear();
+        getRenderablesInRect(visibleTiles, mVisibleActors, mVisibleItems);
+
+        for (Actor* actor : mVisibleActors)
         {
-            auto tmp = mActors[i]->mAnimation.getCurrentRealFrame();
+            auto tmp = actor->mAnimation.getCurrentRealFrame();
 
             FARender::FASpriteGroup* sprite = tmp.first;
             int32_t frame = tmp.second;
             boost::optional<Cel::Colour> hoverColor;
-            if (mHoverState.isActorHovered(mActors[i]->getId()))
-                hoverColor = mActors[i]->isEnemy(displayedActor) ? enemyHoverColor() : friendHoverColor();
+            if (mHoverState.isActorHovered(actor->getId()))
+                hoverColor = actor->isEnemy(displayedActor) ? enemyHoverColor() : friendHoverColor();
             // offset the sprite for the current direction of the actor
 
             if (sprite)
             {
-                frame += mActors[i]->getPos().getDirection() * sprite->getAnimLength();
-                state->mObjects.push_back({sprite, static_cast<uint32_t>(frame), mActors[i]->getPos(), hoverColor});
+                frame += actor->getPos().getDirection() * sprite->getAnimLength();
+                FARender::RenderState::addObject(state->mObjects, sprite, static_cast<uint32_t>(frame), actor->getPos(), hoverColor);
             }
+        }
 
-            for (auto& p : mItemMap->mItems)
-            {
-                auto sf = p.second.getSpriteFrame();
-                FARender::ObjectToRender o;
-                o.spriteGroup = sf.first;
-                o.frame = sf.second;
-                o.position = {p.first.x, p.first.y};
-                if (mHoverState.isItemHovered(p.first))
-                    o.hoverColor = itemHoverColor();
-                state->mItems.push_back(o);
-            }
+        for (PlacedItemData* item : mVisibleItems)
+        {
+            auto sf = item->getSpriteFrame();
+            Tile tile = item->getTile();
+            boost::optional<Cel::Colour> hoverColor;
+            if (mHoverState.isItemHovered(tile))
+                hoverColor = itemHoverColor();
+            FARender::RenderState::addObject(state->mItems, sf.first, sf.second, Position(tile.x, tile.y), hoverColor);
         }
     }
 
     void GameLevel::removeActor(Actor* actor)
     {
-        for (auto i = mActors.begin(); i != mActors.end(); ++i)
+        for (size_t i = 0; i < mActors.size(); i++)
         {
-            if (*i == actor)
+            if (mActors[i] == actor)
             {
-                mActors.erase(i);
-                actorMapRemove(actor);
+                mActorGrid.remove(mActorHandles[i]);
+                mActors.erase(mActors.begin() + i);
+                mActorHandles.erase(mActorHandles.begin() + i);
+
+                mFlowFields.erase(std::remove_if(mFlowFields.begin(),
+                                                 mFlowFields.end(),
+                                                 [actor](const std::pair<int32_t, FlowField>& flowField) { return flowField.first == actor->getId(); }),
+                                  mFlowFields.end());
                 return;
             }
         }
@@ -187,7 +270,7 @@ namespace FAWorld
     bool GameLevel::isPassableFor(int x, int y, const Actor* actor) const
     {
         auto actorAtPos = getActorAt(x, y);
-        return mLevel[x][y].passable() && (actorAtPos == nullptr || actorAtPos == actor || actorAtPos->isPassable());
+        return mLevel.isPassable(x, y) && (actorAtPos == nullptr || actorAtPos == actor || actorAtPos->isPassable());
     }
 
     bool GameLevel::dropItem(std::unique_ptr<Item>&& item, const Actor& actor, const Tile& tile) { return mItemMap->dropItem(move(item), actor, tile); }
@@ -2,12 +2,13 @@
 #define FAWORLD_LEVEL_H
 
 #include <level/level.h>
-#include <unordered_map>
 
 #include <enet/enet.h> // TODO: remove
 
+#include "actorgrid.h"
+#include "flowfield.h"
 #include "hoverstate.h"
-#include <misc/stdhashes.h>
+#include <misc/misc.h>
 
 namespace FARender
 {
@@ -25,6 +26,7 @@ namespace FAWorld
 {
     class Actor;
     class ItemMap;
+    class PlacedItemData;
     class Tile;
 
     class GameLevelImpl
@@ -61,17 +63,26 @@ namespace FAWorld
 
         void update(bool noclip);
 
-        void actorMapInsert(Actor* actor);
-        void actorMapRemove(Actor* actor);
-        void actorMapClear();
-        void actorMapRefresh();
+        /// Walkable, and no living actor on it. Two flat grid reads: the level's static passability and the actor grid's
+        /// blocking counts, for pathfinding to call on every neighbour it looks at. False outside the level.
         virtual bool isPassable(int x, int y) const;
 
+        /// Where a living and a dead actor share a tile, the living one
         Actor* getActorAt(int32_t x, int32_t y) const;
+        /// Appends each actor, dead or alive, whose current tile is within radius tiles of centre
+        void getActorsInRadius(std::pair<int32_t, int32_t> centre, int32_t radius, std::vector<Actor*>& actors) const;
 
         void addActor(Actor* actor);
 
-        void fillRenderState(FARender::RenderState* state, Actor* displayedActor);
+        /// How far the tiles around the actor with targetId are from them, for everything chasing them to share. Only ever filled in
+        /// at the start of update(), so every chaser steps by where the target was then. A field asked for mid-update is empty, all
+        /// UNREACHABLE, until the next one, and is kept up to date from then on until they leave the level. Null if they aren't on it.
+        const FlowField* getFlowField(int32_t targetId);
+
+        /// Appends everything drawn on top of the level that stands on a tile inside rect: actors to actors, ground items to items
+        void getRenderablesInRect(const Misc::TileRect& rect, std::vector<Actor*>& actors, std::vector<PlacedItemData*>& items);
+        /// Only what's inside visibleTiles is put in the state, see FARender::Renderer::getVisibleTiles()
+        void fillRenderState(FARender::RenderState* state, Actor* displayedActor, const Misc::TileRect& visibleTiles);
 
         void removeActor(Actor* actor);
 
@@ -89,15 +100,23 @@ namespace FAWorld
     private:
         GameLevel();
 
+        void actorGridMove(size_t actorIndex);
+        void updateFlowField(FlowField& field, const Actor* target);
+
         Level::Level mLevel;
         int32_t mLevelIndex = 0;
 
         std::vector<Actor*> mActors;
-        std::unordered_map<std::pair<int32_t, int32_t>, Actor*> mActorMap2D; ///< Map of points to actors.
-                                                                             ///< Where an actor straddles two squares, they shall be placed in both.
+        ActorGrid mActorGrid;                                   ///< Where an actor straddles two tiles, it's on both
+        std::vector<ActorGrid::Handle> mActorHandles;           ///< mActorGrid handles, parallel to mActors
+        std::vector<std::pair<int32_t, FlowField>> mFlowFields; ///< keyed by the id of the actor they lead to
         friend class FARender::Renderer;
         HoverState mHoverState;
         std::unique_ptr<ItemMap> mItemMap;
+
+        // only used by fillRenderState, kept around so their storage is reused every tick
+        std::vector<Actor*> mVisibleActors;
+        std::vector<PlacedItemData*> mVisibleItems;
     };
 }
 
@@ -32,7 +32,7 @@ namespace FAWorld
 
         if (!mObjcursLoaded)
         {
-            mObjcurs = new Cel::CelFile("data/inv/objcurs.cel");
+            mObjcurs = new Cel::CelFile("data/inv/objcurs.cel", Cel::FrameFormat::Indexed);
             mObjcursLoaded = true;
         }
 
@@ -81,7 +81,7 @@ namespace FAWorld
         {
 
             mGraphicValue += 11;
-            Cel::CelFrame frame = (*mObjcurs)[mGraphicValue];
+            const Cel::CelFrame& frame = (*mObjcurs)[mGraphicValue];
             mSizeX = static_cast<uint8_t>(frame.mWidth / 28);
             mSizeY = static_cast<uint8_t>(frame.mHeight / 28);
             mMaxCount = 1;
@@ -1,5 +1,7 @@
 #include "itemmap.h"
 
+#include <algorithm>
+
 #include "item.h"
 
 #include "../engine/threadmanager.h"
@@ -72,6 +74,16 @@ namespace FAWorld
         return &it->second;
     }
 
+    void ItemMap::getItemsInRect(const Misc::TileRect& rect, std::vector<PlacedItemData*>& items)
+    {
+        // mItems is sorted by x then y, so each column of the rect is one contiguous run
+        for (int32_t x = std::max(rect.minX, 0), maxX = std::min(rect.maxX, mWidth - 1); x <= maxX; x++)
+        {
+            for (auto it = mItems.lower_bound(Tile(x, rect.minY)); it != mItems.end() && it->first.x == x && it->first.y <= rect.maxY; ++it)
+                items.push_back(&it->second);
+        }
+    }
+
     std::unique_ptr<Item> ItemMap::takeItemAt(const Tile& tile)
     {
         auto it = mItems.find({tile.x, tile.y});
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "misc/helper2d.h"
+#include <misc/misc.h>
 #include <boost/optional/optional.hpp>
 
 namespace FARender
@@ -89,6 +90,8 @@ namespace FAWorld
         bool dropItem(std::unique_ptr<FAWorld::Item>&& item, const Actor& actor, const Tile& tile);
         PlacedItemData* getItemAt(const Tile& tile);
         std::unique_ptr<FAWorld::Item> takeItemAt(const Tile& tile);
+        /// Appends the items lying on tiles inside rect to items
+        void getItemsInRect(const Misc::TileRect& rect, std::vector<PlacedItemData*>& items);
 
     private:
         int32_t mWidth, mHeight;
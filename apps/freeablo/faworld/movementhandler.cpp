@@ -1,10 +1,13 @@
 #include "movementhandler.h"
 
 #include "../fasavegame/gameloader.h"
+#include "actor.h"
 #include "findpath.h"
 
 namespace FAWorld
 {
+    constexpr int32_t MovementHandler::LONG_PATH_DISTANCE;
+
     MovementHandler::MovementHandler(Tick pathRateLimit) : mPathRateLimit(pathRateLimit) {}
 
     MovementHandler::MovementHandler(FASaveGame::GameLoader& loader)
@@ -36,6 +39,7 @@ namespace FAWorld
         mLastRepathed = loader.load<Tick>();
         mPathRateLimit = loader.load<Tick>();
         mAdjacent = loader.load<bool>();
+        mChaseTargetId = loader.load<int32_t>();
     }
 
     void MovementHandler::save(FASaveGame::GameSaver& saver)
@@ -64,6 +68,7 @@ namespace FAWorld
         saver.save(mLastRepathed);
         saver.save(mPathRateLimit);
         saver.save(mAdjacent);
+        saver.save(mChaseTargetId);
     }
 
     std::pair<int32_t, int32_t> MovementHandler::getDestination() const { return mDestination; }
@@ -72,6 +77,13 @@ namespace FAWorld
     {
         mDestination = dest;
         mAdjacent = adjacent;
+        mChaseTargetId = -1;
+    }
+
+    void MovementHandler::chase(const Actor* target)
+    {
+        setDestination(target->getPos().current());
+        mChaseTargetId = target->getId();
     }
 
     bool MovementHandler::moving() { return mCurrentPos.isMoving(); }
@@ -99,7 +111,11 @@ namespace FAWorld
                 bool needsRepath = true;
                 mCurrentPos.stop();
 
-                if (mCurrentPathIndex < (int32_t)mCurrentPath.size())
+                if (followFlowField())
+                {
+                    needsRepath = false;
+                }
+                else if (mCurrentPathIndex < (int32_t)mCurrentPath.size())
                 {
                     // If our destination hasn't changed, or we can't repath, keep moving along our current path
                     if (mCurrentPath[mCurrentPath.size() - 1] == mDestination || !canRepath)
@@ -122,8 +138,13 @@ namespace FAWorld
                 {
                     mLastRepathed = World::get()->getCurrentTick();
 
+                    // Plain A* gives up long before reaching somewhere far away, jump point search gets there but costs more up close
+                    std::pair<int32_t, int32_t> current = mCurrentPos.current();
+                    int32_t distance = std::max(std::abs(mDestination.first - current.first), std::abs(mDestination.second - current.second));
+                    PathAlgorithm algorithm = distance > LONG_PATH_DISTANCE ? PathAlgorithm::JumpPoint : PathAlgorithm::AStar;
+
                     bool _;
-                    mCurrentPath = std::move(pathFind(mLevel, mCurrentPos.current(), mDestination, _, mAdjacent));
+                    pathFind(mLevel, current, mDestination, _, mAdjacent, mCurrentPath, algorithm);
                     mCurrentPathIndex = 0;
 
                     update(actorId);
@@ -135,6 +156,32 @@ namespace FAWorld
         mCurrentPos.update();
     }
 
+    bool MovementHandler::followFlowField()
+    {
+        if (mChaseTargetId == -1)
+            return false;
+
+        const FlowField* field = mLevel->getFlowField(mChaseTargetId);
+        std::pair<int32_t, int32_t> current = mCurrentPos.current();
+
+        if (!field || field->distance(current.first, current.second) == FlowField::UNREACHABLE)
+            return false;
+
+        // Wait where we are if we're already next to them or others are in the way, it'll be worth looking again next update
+        std::pair<int32_t, int32_t> next;
+        if (field->nextStep(current, next, [this](int32_t x, int32_t y) { return mLevel->isPassable(x, y); }))
+        {
+            mCurrentPos.setDirection(Misc::getVecDir(Misc::getVec(current, next)));
+            mCurrentPos.start();
+        }
+
+        // Any path we had is out of date by the time we're off the field again
+        mCurrentPath.clear();
+        mCurrentPathIndex = 0;
+
+        return true;
+    }
+
     void MovementHandler::teleport(GameLevel* level, Position pos)
     {
         mLevel = level;
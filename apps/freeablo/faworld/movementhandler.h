@@ -3,6 +3,7 @@
 #include "gamelevel.h"
 #include "position.h"
 #include "world.h"
+#include <limits>
 
 namespace FASaveGame
 {
@@ -12,11 +13,14 @@ namespace FASaveGame
 
 namespace FAWorld
 {
+    class Actor;
     class GameLevel;
 
     class MovementHandler
     {
     public:
+        static constexpr int32_t LONG_PATH_DISTANCE = 20; ///< destinations further than this many tiles use jump point search
+
         MovementHandler(Tick pathRateLimit);
 
         MovementHandler(FASaveGame::GameLoader& loader);
@@ -24,6 +28,9 @@ namespace FAWorld
 
         std::pair<int32_t, int32_t> getDestination() const;
         void setDestination(std::pair<int32_t, int32_t> dest, bool adjacent = false);
+        /// Like setDestination(target's tile), but while target's flow field covers where we are, follow that instead of pathfinding.
+        /// Needs calling again each update to keep up with target, the same as setDestination() would.
+        void chase(const Actor* target);
 
         bool moving();
         const Position& getCurrentPosition() const { return mCurrentPos; }
@@ -32,6 +39,8 @@ namespace FAWorld
         void teleport(GameLevel* level, Position pos);
 
     private:
+        bool followFlowField();
+
         GameLevel* mLevel = nullptr;
         Position mCurrentPos;
         std::pair<int32_t, int32_t> mDestination;
@@ -41,5 +50,6 @@ namespace FAWorld
         Tick mLastRepathed = std::numeric_limits<Tick>::min();
         Tick mPathRateLimit;
         bool mAdjacent = false;
+        int32_t mChaseTargetId = -1; ///< the actor chase() was last given, -1 if setDestination() has been called since
     };
 }
@@ -33,7 +33,7 @@ namespace FAWorld
     {
         if (mMoving)
         {
-            mDist += static_cast<int32_t>(FAWorld::World::getSecondsPerTick() * 250);
+            mDist += getDistPerTick();
 
             if (mDist >= 100)
             {
@@ -43,6 +43,14 @@ namespace FAWorld
         }
     }
 
+    int32_t Position::getDistPerTick() const
+    {
+        if (!mMoving)
+            return 0;
+
+        return static_cast<int32_t>(FAWorld::World::getSecondsPerTick() * 250);
+    }
+
     void Position::setDirection(int32_t mDirection)
     {
         if (mDirection >= 0)
@@ -35,6 +35,7 @@ namespace FAWorld
 
         bool isMoving() const { return mMoving; }
         int32_t getDist() const { return mDist; }
+        int32_t getDistPerTick() const; ///< how much update() will add to the dist, for drawing in between ticks
 
         void stop();
         void start();
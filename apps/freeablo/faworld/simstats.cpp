@@ -0,0 +1,20 @@
+#include "simstats.h"
+
+namespace FAWorld
+{
+    namespace SimStats
+    {
+        Misc::TimeCounter pathFinding;
+        Misc::TimeCounter behaviour;
+        Misc::TimeCounter actorMap;
+        Misc::TimeCounter flowFields;
+
+        void reset()
+        {
+            pathFinding.reset();
+            behaviour.reset();
+            actorMap.reset();
+            flowFields.reset();
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef FAWORLD_SIMSTATS_H
+#define FAWORLD_SIMSTATS_H
+
+#include <misc/timecounter.h>
+
+namespace FAWorld
+{
+    ///
+    /// Where the time in World::update goes, reported by the headless benchmark (apps/simbench).
+    /// Only counted while Misc::TimeCounter::setEnabled(true), and only from the game thread.
+    ///
+    namespace SimStats
+    {
+        extern Misc::TimeCounter pathFinding; ///< pathFind(), including the actor map lookups it makes
+        extern Misc::TimeCounter behaviour;   ///< monster behaviour updates, not counting the movement they start
+        extern Misc::TimeCounter actorMap;    ///< keeping GameLevel's actor grid up to date in GameLevel::update()
+        extern Misc::TimeCounter flowFields;  ///< keeping GameLevel's flow fields up to date with where their actors are
+
+        void reset();
+    }
+}
+
+#endif
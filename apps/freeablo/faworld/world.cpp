@@ -16,14 +16,36 @@
 #include "player.h"
 #include <algorithm>
 #include <diabloexe/diabloexe.h>
+#include <faio/faio.h>
 #include <iostream>
 #include <misc/assert.h>
+#include <misc/profiler.h>
+#include <sstream>
 #include <tuple>
 
 namespace FAWorld
 {
     World* singletonInstance = nullptr;
 
+    // The files that generating and drawing a level will need, so they can be prefetched
+    static std::vector<std::string> levelAssetPaths(int32_t levelNum)
+    {
+        if (levelNum == 0)
+            return {"levels/towndata/town.cel", "levels/towndata/town.til", "levels/towndata/town.min", "levels/towndata/town.sol"};
+
+        int32_t tilesetNum = ((levelNum - 1) / 4) + 1;
+
+        std::vector<std::string> paths;
+        for (const char* extension : {".cel", ".til", ".min", ".sol"})
+        {
+            std::stringstream ss;
+            ss << "levels/l" << tilesetNum << "data/l" << tilesetNum << extension;
+            paths.push_back(ss.str());
+        }
+
+        return paths;
+    }
+
     World::World(const DiabloExe::DiabloExe& exe) : mDiabloExe(exe)
     {
         release_assert(singletonInstance == nullptr);
@@ -231,10 +253,20 @@ namespace FAWorld
         if (levelNum >= int32_t(mLevels.size()) || levelNum < 0 || (mCurrentPlayer->getLevel() && mCurrentPlayer->getLevel()->getLevelIndex() == levelNum))
             return;
 
+        // Mostly just lets the files load in parallel, as getLevel needs them straight away
+        FAIO::prefetch(levelAssetPaths(levelNum), FAIO::PREFETCH_PRIORITY_SOON);
+
         auto level = getLevel(levelNum);
 
         mCurrentPlayer->teleport(level, FAWorld::Position(level->upStairsPos().first, level->upStairsPos().second));
         playLevelMusic(levelNum);
+
+        // Stairs only go one level up or down, so get those ready while the player is busy on this one
+        for (int32_t adjacent : {level->getPreviousLevel(), level->getNextLevel()})
+        {
+            if (adjacent >= 0 && adjacent < int32_t(mLevels.size()))
+                FAIO::prefetch(levelAssetPaths(adjacent), FAIO::PREFETCH_PRIORITY_BACKGROUND);
+        }
     }
 
     HoverState& World::getHoverState() { return getCurrentLevel()->getHoverState(); }
@@ -305,6 +337,8 @@ namespace FAWorld
 
     void World::update(bool noclip)
     {
+        FA_PROFILE_ZONE("World::update");
+
         mTicksPassed++;
 
         std::set<GameLevel*> done;
@@ -321,6 +355,8 @@ namespace FAWorld
             }
         }
 
+        // nothing to hover over without a GUI, as when running headless
+        if (mGuiManager)
         {
             if (!nk_item_is_any_active(FARender::Renderer::get()->getNuklearContext()))
             {
@@ -359,10 +395,10 @@ namespace FAWorld
 
     const std::vector<Player*>& World::getPlayers() { return mPlayers; }
 
-    void World::fillRenderState(FARender::RenderState* state)
+    void World::fillRenderState(FARender::RenderState* state, const Misc::TileRect& visibleTiles)
     {
         if (getCurrentLevel())
-            getCurrentLevel()->fillRenderState(state, getCurrentPlayer());
+            getCurrentLevel()->fillRenderState(state, getCurrentPlayer(), visibleTiles);
     }
 
     Actor* World::getActorById(int32_t id)
@@ -14,6 +14,11 @@ namespace FARender
     class RenderState;
 }
 
+namespace Misc
+{
+    struct TileRect;
+}
+
 namespace DiabloExe
 {
     class DiabloExe;
@@ -82,7 +87,7 @@ namespace FAWorld
         void deregisterPlayer(Player* player);
         const std::vector<Player*>& getPlayers();
 
-        void fillRenderState(FARender::RenderState* state);
+        void fillRenderState(FARender::RenderState* state, const Misc::TileRect& visibleTiles);
 
         static const Tick ticksPerSecond = 125; ///< number of times per second that game state will be updated
         static Tick getTicksInPeriod(float seconds);
@@ -6,6 +6,7 @@
 #include <stdio.h>
 
 #include <faio/fafileobject.h>
+#include <settings/settings.h>
 
 int main(int argc, char** argv)
 {
@@ -20,6 +21,12 @@ int main(int argc, char** argv)
 
     FAIO::init();
 
+    Settings::Settings settings;
+    settings.loadUserSettings();
+
+    if (settings.get<std::string>("Cache", "enabled") == "true")
+        FAIO::initDiskCache(settings.get<std::string>("Cache", "directory"), settings.get<uint64_t>("Cache", "maxSizeMB") * 1024 * 1024);
+
     FAIO::FAFileObject file(argv[1]);
     FILE* output = fopen(argv[2], "w");
 
@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <diabloexe/diabloexe.h>
+#include <diabloexe/monster.h>
+#include <faio/fafileobject.h>
+#include <misc/allocationcounter.h>
+#include <misc/timecounter.h>
+#include <misc/timinghistogram.h>
+#include <settings/settings.h>
+
+#include "../freeablo/engine/threadmanager.h"
+#include "../freeablo/falevelgen/random.h"
+#include "../freeablo/farender/renderer.h"
+#include "../freeablo/faworld/actor.h"
+#include "../freeablo/faworld/gamelevel.h"
+#include "../freeablo/faworld/itemmanager.h"
+#include "../freeablo/faworld/player.h"
+#include "../freeablo/faworld/playerfactory.h"
+#include "../freeablo/faworld/simstats.h"
+#include "../freeablo/faworld/world.h"
+
+///
+/// Runs the game simulation headless, with no window, GL or audio, as fast as it will go, and reports how long it took.
+/// Levels, monsters and the players' wandering all come from --seed, so two runs with the same options simulate the same
+/// game, and the state hash printed at the end should match.
+/// Still needs DIABDAT.MPQ and Diablo.exe, the same as the game does.
+///
+
+namespace bpo = boost::program_options;
+
+static bool parseOptions(int argc, char** argv, bpo::variables_map& variables)
+{
+    bpo::options_description desc("Options");
+    desc.add_options()("help,h", "Print help")("seed,s", bpo::value<int32_t>()->default_value(1), "Seed for the level generator and everything random after")(
+        "level,l", bpo::value<int32_t>()->default_value(1), "Dungeon level to run on (1-16)")(
+        "monsters,m", bpo::value<int32_t>()->default_value(0), "Monsters to add on top of the ones the level is generated with")(
+        "players,p", bpo::value<int32_t>()->default_value(1), "Number of players, who wander the level")(
+        "ticks,t", bpo::value<int32_t>()->default_value(10000), "Number of ticks to run")(
+        "render", "Also fill in a render state for the first player's view every tick, as the game does, and walk it like drawLevel")(
+        "character,c", bpo::value<std::string>()->default_value("Warrior"), "Choose Warrior, Rogue or Sorcerer");
+
+    try
+    {
+        bpo::store(bpo::parse_command_line(argc, argv, desc), variables);
+
+        if (variables.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        bpo::notify(variables);
+
+        const int32_t dLvl = variables["level"].as<int32_t>();
+        if (dLvl < 1 || dLvl > 16)
+            throw bpo::error("level has to be a dungeon level, 1-16");
+
+        if (variables["players"].as<int32_t>() < 1)
+            throw bpo::error("there has to be at least one player");
+    }
+    catch (bpo::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static std::pair<int32_t, int32_t> randomFreeTile(const FAWorld::GameLevel& level)
+{
+    std::pair<int32_t, int32_t> tile;
+    do
+    {
+        tile.first = FALevelGen::randomInRange(1, level.width() - 2);
+        tile.second = FALevelGen::randomInRange(1, level.height() - 2);
+    } while (!level.isPassable(tile.first, tile.second));
+
+    return tile;
+}
+
+/// Sends the player somewhere within range tiles of where they are now, if it finds a free tile there
+static void wander(FAWorld::Player* player, int32_t range)
+{
+    const FAWorld::GameLevel& level = *player->getLevel();
+
+    for (int32_t tries = 0; tries < 10; tries++)
+    {
+        std::pair<int32_t, int32_t> dest = player->getPos().current();
+        dest.first += FALevelGen::randomInRange(0, range * 2) - range;
+        dest.second += FALevelGen::randomInRange(0, range * 2) - range;
+
+        if (dest.first > 0 && dest.first < level.width() - 1 && dest.second > 0 && dest.second < level.height() - 1 &&
+            level.isPassable(dest.first, dest.second))
+        {
+            player->mMoveHandler.setDestination(dest);
+            return;
+        }
+    }
+}
+
+/// Where everything is and whether it's alive, so runs can be checked against each other for determinism
+static uint64_t stateHash(FAWorld::World& world)
+{
+    std::vector<FAWorld::Actor*> actors;
+    world.getAllActors(actors);
+
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](int64_t value) {
+        for (int32_t i = 0; i < 8; i++)
+        {
+            hash ^= uint64_t(value >> (i * 8)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+
+    for (FAWorld::Actor* actor : actors)
+    {
+        add(actor->getId());
+        add(actor->getPos().current().first);
+        add(actor->getPos().current().second);
+        add(actor->isDead());
+    }
+
+    return hash;
+}
+
+/// What drawLevel reads of the objects on screen, without drawing anything
+static int64_t walkRenderState(const FARender::RenderState& state, const Misc::TileRect& visible, const FAWorld::GameLevel& level)
+{
+    int64_t sum = 0;
+
+    for (int32_t y = std::max(visible.minY, 0); y <= std::min(visible.maxY, level.height() - 1); y++)
+    {
+        for (int32_t x = std::max(visible.minX, 0); x <= std::min(visible.maxX, level.width() - 1); x++)
+        {
+            for (const auto& item : state.mItems.objects(x, y))
+                sum += item.spriteCacheIndex + item.spriteFrame + (state.mItems.hoverColor(item) ? 1 : 0);
+
+            for (const auto& obj : state.mObjects.objects(x, y))
+                sum += obj.spriteCacheIndex + obj.spriteFrame + obj.x2 + obj.y2 + obj.dist + (state.mObjects.hoverColor(obj) ? 1 : 0);
+        }
+    }
+
+    return sum;
+}
+
+static void printCounter(const std::string& name, const Misc::TimeCounter& counter, std::chrono::steady_clock::duration total)
+{
+    double seconds = std::chrono::duration<double>(counter.total()).count();
+    double percent = 100.0 * seconds / std::chrono::duration<double>(total).count();
+
+    std::cout << std::setw(12) << std::left << name << std::right << std::setw(10) << counter.calls() << " calls, " << std::setprecision(3) << seconds << "s ("
+              << std::setprecision(1) << percent << "%)" << std::endl;
+}
+
+static bool run(const bpo::variables_map& variables, const std::string& pathEXE)
+{
+    const int32_t seed = variables["seed"].as<int32_t>();
+    const int32_t levelNum = variables["level"].as<int32_t>();
+    const int32_t extraMonsters = variables["monsters"].as<int32_t>();
+    const int32_t playerCount = variables["players"].as<int32_t>();
+    const int32_t ticks = variables["ticks"].as<int32_t>();
+    const bool render = variables.count("render") != 0;
+
+    Engine::ThreadManager threadManager(true);
+    FARender::Renderer renderer(640, 480, false, false, true);
+
+    FALevelGen::FAsrand(seed);
+
+    DiabloExe::DiabloExe exe(pathEXE);
+    if (!exe.isLoaded())
+        return false;
+
+    FAWorld::ItemManager::get().loadItems(&exe);
+    FAWorld::PlayerFactory playerFactory(exe);
+
+    FAWorld::World world(exe);
+    world.generateLevels();
+
+    std::vector<FAWorld::Player*> players;
+    for (int32_t i = 0; i < playerCount; i++)
+        players.push_back(playerFactory.create(variables["character"].as<std::string>()));
+
+    world.addCurrentPlayer(players[0]);
+    world.setLevel(levelNum);
+    FAWorld::GameLevel* level = world.getCurrentLevel();
+
+    for (FAWorld::Player* player : players)
+    {
+        // Nothing would be left to simulate once the monsters had killed everyone
+        player->mInvuln = true;
+
+        if (player != players[0])
+        {
+            std::pair<int32_t, int32_t> tile = randomFreeTile(*level);
+            player->teleport(level, FAWorld::Position(tile.first, tile.second));
+        }
+    }
+
+    std::vector<const DiabloExe::Monster*> possibleMonsters = exe.getMonstersInLevel(levelNum);
+    for (int32_t i = 0; i < extraMonsters; i++)
+    {
+        std::pair<int32_t, int32_t> tile = randomFreeTile(*level);
+        std::string name = possibleMonsters[FALevelGen::randomInRange(0, possibleMonsters.size() - 1)]->monsterName;
+
+        FAWorld::Actor* monster = new FAWorld::Actor(exe.getMonster(name));
+        monster->teleport(level, FAWorld::Position(tile.first, tile.second));
+    }
+
+    std::vector<FAWorld::Actor*> actors;
+    level->getActors(actors);
+    std::cout << "seed " << seed << ", level " << levelNum << ", " << playerCount << " players, " << actors.size() - playerCount << " monsters, " << ticks
+              << " ticks" << std::endl;
+
+    const FAWorld::Tick wanderInterval = FAWorld::World::getTicksInPeriod(2.0f);
+
+    FAWorld::SimStats::reset();
+    Misc::TimeCounter::setEnabled(true);
+    Misc::TimingHistogram tickTimes;
+    Misc::TimeCounter renderStateCounter;
+    int64_t renderStateSum = 0;
+
+    uint64_t startAllocations = Misc::AllocationCounter::count();
+    uint64_t startBytes = Misc::AllocationCounter::totalBytes();
+    auto start = std::chrono::steady_clock::now();
+
+    for (int32_t tick = 0; tick < ticks; tick++)
+    {
+        auto tickStart = std::chrono::steady_clock::now();
+
+        if (tick % wanderInterval == 0)
+        {
+            for (FAWorld::Player* player : players)
+                wander(player, 15);
+        }
+
+        world.update(false);
+
+        if (render)
+        {
+            Misc::TimeCounter::Scope counter(renderStateCounter);
+
+            FARender::RenderState* state = renderer.getFreeState();
+            Misc::TileRect visible = renderer.getVisibleTiles(players[0]->getPos());
+            world.fillRenderState(state, visible);
+            renderStateSum += walkRenderState(*state, visible, *level);
+        }
+
+        tickTimes.record(std::chrono::steady_clock::now() - tickStart);
+    }
+
+    auto total = std::chrono::steady_clock::now() - start;
+    uint64_t allocations = Misc::AllocationCounter::count() - startAllocations;
+    uint64_t bytes = Misc::AllocationCounter::totalBytes() - startBytes;
+    Misc::TimeCounter::setEnabled(false);
+
+    double seconds = std::chrono::duration<double>(total).count();
+
+    std::cout << std::fixed << std::setprecision(2) << seconds << "s, " << std::setprecision(0) << ticks / seconds
+              << " ticks/s, tick times: " << tickTimes.summary() << std::endl;
+    std::cout << "allocations: " << allocations << " (" << std::setprecision(1) << double(allocations) / ticks << " per tick), "
+              << double(bytes) / (1024 * 1024) << " MB" << std::endl;
+    printCounter("pathfinding", FAWorld::SimStats::pathFinding, total);
+    printCounter("behaviour", FAWorld::SimStats::behaviour, total);
+    printCounter("actor map", FAWorld::SimStats::actorMap, total);
+    printCounter("flow fields", FAWorld::SimStats::flowFields, total);
+    if (render)
+        std::cout << "render state: " << renderStateCounter.calls() << " calls, " << std::setprecision(1)
+                  << std::chrono::duration<double, std::micro>(renderStateCounter.total()).count() / std::max<uint64_t>(renderStateCounter.calls(), 1)
+                  << "us each (walk sum " << renderStateSum << ")" << std::endl;
+    std::cout << "state hash: " << std::hex << stateHash(world) << std::dec << std::endl;
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    bpo::variables_map variables;
+    if (!parseOptions(argc, argv, variables))
+        return EXIT_FAILURE;
+
+    Settings::Settings settings;
+    if (!settings.loadUserSettings())
+        return EXIT_FAILURE;
+
+    if (!FAIO::init(settings.get<std::string>("Game", "PathMPQ")))
+        return EXIT_FAILURE;
+
+    if (settings.get<std::string>("Cache", "enabled") == "true")
+        FAIO::initDiskCache(settings.get<std::string>("Cache", "directory"), settings.get<uint64_t>("Cache", "maxSizeMB") * 1024 * 1024);
+
+    std::string pathEXE = settings.get<std::string>("Game", "PathEXE");
+    if (pathEXE == "")
+        pathEXE = "Diablo.exe";
+
+    int retval = run(variables, pathEXE) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    FAIO::FAFileObject::quit();
+    return retval;
+}
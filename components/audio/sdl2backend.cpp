@@ -7,7 +7,7 @@
 #include <SDL.h>
 #include <SDL_mixer.h>
 
-#include <faio/fafileobject.h>
+#include <faio/faio.h>
 
 namespace Audio
 {
@@ -26,55 +26,53 @@ namespace Audio
         Mix_Quit();
     }
 
+    // Music is streamed from the buffer while playing, so it has to stay alive as long as the Mix_Music
+    typedef std::pair<Mix_Music*, FAIO::FileBufferPtr> MusicData;
+
     Music* loadMusic(const std::string& path)
     {
-        FAIO::FAFileObject f(path);
-        size_t len = f.FAsize();
-        uint8_t* buffer = new uint8_t[len];
-        f.FAfread(buffer, 1, len);
+        FAIO::FileBufferPtr buffer = FAIO::readAll(path);
+        if (!buffer)
+            return NULL;
 
-        SDL_RWops* rw = SDL_RWFromMem(buffer, len);
+        SDL_RWops* rw = SDL_RWFromConstMem(buffer->data(), buffer->size());
 
-        Music* mus = (Music*)new std::pair<Mix_Music*, uint8_t*>(Mix_LoadMUS_RW(rw, 1), buffer);
+        Music* mus = (Music*)new MusicData(Mix_LoadMUS_RW(rw, 1), buffer);
         return mus;
     }
 
     void freeMusic(Music* mus)
     {
-        std::pair<Mix_Music*, uint8_t*>* data = (std::pair<Mix_Music*, uint8_t*>*)mus;
+        if (!mus)
+            return;
+
+        MusicData* data = (MusicData*)mus;
         Mix_FreeMusic(data->first);
-        delete[] data->second;
         delete data;
     }
 
-    void playMusic(Music* mus) { Mix_PlayMusic(((std::pair<Mix_Music*, uint8_t*>*)mus)->first, -1); }
+    void playMusic(Music* mus)
+    {
+        if (mus)
+            Mix_PlayMusic(((MusicData*)mus)->first, -1);
+    }
 
+    // Sounds are fully decoded by Mix_LoadWAV_RW, so the file contents can be dropped straight away
     Sound* loadSound(const std::string& path)
     {
-        FAIO::FAFileObject f(path);
-        size_t len = f.FAsize();
-        uint8_t* buffer = new uint8_t[len];
-        f.FAfread(buffer, 1, len);
+        FAIO::FileBufferPtr buffer = FAIO::readAll(path);
+        if (!buffer)
+            return NULL;
 
-        SDL_RWops* rw = SDL_RWFromMem(buffer, len);
+        SDL_RWops* rw = SDL_RWFromConstMem(buffer->data(), buffer->size());
 
-        Sound* sound = (Sound*)new std::pair<Mix_Chunk*, uint8_t*>(Mix_LoadWAV_RW(rw, 1), buffer);
+        Sound* sound = (Sound*)Mix_LoadWAV_RW(rw, 1);
         return sound;
     }
 
-    void freeSound(Sound* sound)
-    {
-        std::pair<Mix_Chunk*, uint8_t*>* data = (std::pair<Mix_Chunk*, uint8_t*>*)sound;
-        Mix_FreeChunk(data->first);
-        delete[] data->second;
-        delete data;
-    }
+    void freeSound(Sound* sound) { Mix_FreeChunk((Mix_Chunk*)sound); }
 
-    int32_t playSound(Sound* sound)
-    {
-        std::pair<Mix_Chunk*, uint8_t*>* data = (std::pair<Mix_Chunk*, uint8_t*>*)sound;
-        return Mix_PlayChannel(-1, data->first, 0);
-    }
+    int32_t playSound(Sound* sound) { return Mix_PlayChannel(-1, (Mix_Chunk*)sound, 0); }
 
     void stopSound() { Mix_HaltChannel(-1); }
 
@@ -1,28 +1,21 @@
 #include "celdecoder.h"
+#include "framewriter.h"
+#include <algorithm>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/range/adaptor/transformed.hpp>
-#include <faio/fafileobject.h>
+#include <faio/faio.h>
 #include <functional>
 #include <iostream>
 #include <misc/stringops.h>
+#include <misc/threadpool.h>
 #include <set>
 
 namespace Cel
 {
-    namespace
-    {
-        struct DecodePal
-        {
-            DecodePal(const Pal& pal) : mPal(pal) {}
-            Colour operator()(uint8_t code) const { return mPal[code]; }
-            const Pal& mPal;
-        };
-    }
-
     Settings::Settings CelDecoder::mSettingsCel;
     Settings::Settings CelDecoder::mSettingsCl2;
 
-    CelDecoder::CelDecoder(const std::string& celPath) : mCelPath(celPath), mAnimationLength(0)
+    CelDecoder::CelDecoder(const std::string& celPath, FrameFormat format) : mCelPath(celPath), mFormat(format), mAnimationLength(0)
     {
         readCelName();
         readConfiguration();
@@ -38,10 +31,10 @@ namespace Cel
             return it->second;
         }
 
-        auto& frame = mFrames[index];
-        CelFrame celFrame;
-        decodeFrame(index, frame, celFrame);
-        return (mCache[index] = celFrame);
+        // Decode straight into the cache, copying a finished frame in costs about as much as decoding it
+        CelFrame& celFrame = mCache[index];
+        decodeFrame(index, mFrames[index], celFrame, mFormat);
+        return celFrame;
     }
 
     int32_t CelDecoder::numFrames() const { return mFrames.size(); }
@@ -129,52 +122,98 @@ namespace Cel
         else
             palFilename = "levels/towndata/town.pal";
 
-        mPal = Pal(palFilename);
+        mPal = std::make_shared<const Pal>(palFilename);
+    }
+
+    void CelDecoder::setPalette(const std::string& palFilename)
+    {
+        mPal = std::make_shared<const Pal>(palFilename);
+
+        // Indexed frames just need to point at the new palette, RGBA ones have the old colours baked in
+        for (auto it = mCache.begin(); it != mCache.end();)
+        {
+            if (it->second.isIndexed())
+            {
+                it->second.mPal = mPal;
+                ++it;
+            }
+            else
+            {
+                it = mCache.erase(it);
+            }
+        }
     }
 
     void CelDecoder::decode()
     {
-        int frameNumber = 0;
-        for (FrameBytesRef frame : mFrames)
+        // The map can't be modified from several threads, so create the missing entries first and only decode in parallel
+        std::vector<std::pair<int32_t, CelFrame*>> missing;
+        for (int32_t i = 0; i < numFrames(); i++)
         {
+            if (!mCache.count(i))
+                missing.push_back(std::make_pair(i, &mCache[i]));
+        }
+
+        Misc::ThreadPool::get().parallelFor(missing.size(), [&](size_t i) {
+            int32_t index = missing[i].first;
+            decodeFrame(index, mFrames[index], *missing[i].second, mFormat);
+        });
+    }
+
+    std::vector<RgbaFrame> CelDecoder::decodeRgba()
+    {
+        std::vector<RgbaFrame> retval(mFrames.size());
+
+        Misc::ThreadPool::get().parallelFor(mFrames.size(), [&](size_t i) {
+            CelFrame decoded;
+            const CelFrame* frame = &decoded;
+
+            auto it = mCache.find(i);
+            if (it != mCache.end())
+                frame = &it->second;
+            else
+                decodeFrame(i, mFrames[i], decoded, FrameFormat::Rgba);
+
+            std::vector<Colour> colours = frame->toRgba();
+
+            RgbaFrame& out = retval[i];
+            out.width = frame->mWidth;
+            out.height = frame->mHeight;
+            out.pixels.resize(colours.size() * 4);
 
-            if (mCache.count(frameNumber))
+            for (size_t p = 0; p < colours.size(); p++)
             {
-                frameNumber++;
-                continue;
+                out.pixels[p * 4] = colours[p].r;
+                out.pixels[p * 4 + 1] = colours[p].g;
+                out.pixels[p * 4 + 2] = colours[p].b;
+                out.pixels[p * 4 + 3] = colours[p].visible ? 255 : 0;
             }
+        });
 
-            CelFrame celFrame;
-            decodeFrame(frameNumber, frame, celFrame);
-            mCache[frameNumber] = celFrame;
-
-            frameNumber++;
-        }
+        return retval;
     }
 
     void CelDecoder::getFrames()
     {
         // Open CEL file.
 
-        FAIO::FAFileObject file(mCelPath);
-        if (!file.isValid())
+        FAIO::FileBufferPtr file = FAIO::readAll(mCelPath);
+        if (!file)
         {
             return;
         }
 
         // Read first word.
         uint32_t frameCount = 0;
-        uint32_t firstWord = 0;
+        uint32_t firstWord = file->read32(0);
         uint32_t repeat = 1;
-        file.FAfread(&firstWord, 4, 1);
+        size_t pos = 0;
 
         std::vector<uint32_t> headerOffsets;
 
         // If firstWord == 32 then it is archive
         // that contains 8 cels and information about offsets in header.
 
-        file.FAfseek(0, SEEK_SET);
-
         if (firstWord == 32)
         {
             repeat = 8;
@@ -182,9 +221,8 @@ namespace Cel
             // Read header offsets
             for (uint32_t i = 0; i < repeat; i++)
             {
-                uint32_t offset = 0;
-                file.FAfread(&offset, 4, 1);
-                headerOffsets.push_back(offset);
+                headerOffsets.push_back(file->read32(pos));
+                pos += 4;
             }
         }
 
@@ -193,23 +231,25 @@ namespace Cel
             // Offset file
             if (!headerOffsets.empty())
             {
-                file.FAfseek(headerOffsets[r], SEEK_SET);
+                pos = headerOffsets[r];
             }
 
             // Read frame count
-            file.FAfread(&frameCount, 4, 1);
+            frameCount = file->read32(pos);
+            pos += 4;
 
             // Read frame offsets.
             std::vector<uint32_t> frameOffsets(frameCount + 1);
             for (uint32_t i = 0; i < frameCount + 1; i++)
             {
-                file.FAfread(&frameOffsets[i], 4, 1);
+                frameOffsets[i] = file->read32(pos);
+                pos += 4;
             }
 
             // Magic offset that fixes everything!
             if (!headerOffsets.empty())
             {
-                file.FAfseek(headerOffsets[r] + frameOffsets[0], SEEK_SET);
+                pos = headerOffsets[r] + frameOffsets[0];
             }
 
             // Read frame contents
@@ -224,35 +264,57 @@ namespace Cel
                     return;
                 }
 
+                pos += mHeaderSize;
+
+                // Anything past the end of the file is left zeroed, same as a short read would
                 mFrames.push_back(std::vector<uint8_t>(static_cast<int32_t>(frameSize)));
-                uint32_t idx = mFrames.size() - 1;
-                file.FAfseek(mHeaderSize, SEEK_CUR);
-                file.FAfread(&mFrames[idx][0], 1, static_cast<int32_t>(frameSize));
+                if (pos < file->size())
+                {
+                    size_t available = std::min<size_t>(frameSize, file->size() - pos);
+                    std::copy(file->data() + pos, file->data() + pos + available, mFrames.back().begin());
+                }
+
+                pos += frameSize;
             }
 
             mAnimationLength = frameCount;
         }
     }
 
-    void CelDecoder::decodeFrame(int32_t index, FrameBytesRef frame, CelFrame& celFrame)
+    void CelDecoder::decodeFrame(int32_t index, FrameBytesRef frame, CelFrame& celFrame, FrameFormat format)
     {
         auto decoder = getFrameDecoder(mCelName, frame, index);
 
+        // Frames can be decoded from several threads at once, so per frame sizes are kept local
+        int width = mFrameWidth;
+        int height = mFrameHeight;
+
         if (mIsObjcursCel)
         {
-            setObjcursCelDimensions(index);
+            getObjcursCelDimensions(index, width, height);
         }
         else if (mIsCharbutCel)
         {
-            setCharbutCelDimensions(index);
+            getCharbutCelDimensions(index, width);
         }
 
-        celFrame.mWidth = mFrameWidth;
-        celFrame.mHeight = mFrameHeight;
-        celFrame.mRawImage.resize(mFrameWidth * mFrameHeight);
-        auto it = celFrame.mRawImage.begin();
-        decoder(*this, frame, mPal, it);
-        // assert (it == celFrame.mRawImage.end ());
+        celFrame.mWidth = width;
+        celFrame.mHeight = height;
+
+        if (format == FrameFormat::Indexed)
+        {
+            celFrame.mIndices.resize(width * height);
+            celFrame.mVisibleMask.resize((width * height + 7) / 8);
+            celFrame.mPal = mPal;
+        }
+        else
+        {
+            celFrame.mRawImage.resize(width * height);
+        }
+
+        FrameWriter writer(celFrame, *mPal);
+        decoder(*this, frame, writer);
+        // assert (writer.position() == width * height);
     }
 
     CelDecoder::FrameDecoder CelDecoder::getFrameDecoder(const std::string& celName, FrameBytesRef frame, int frameNumber)
@@ -365,9 +427,9 @@ namespace Cel
     //
     // Type0 corresponds to a plain 32x32 images, with no transparency.
     //
-    void CelDecoder::decodeFrameType0(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame)
+    void CelDecoder::decodeFrameType0(FrameBytesRef frame, FrameWriter& writer)
     {
-        std::transform(frame.begin(), frame.end(), decodedFrame, DecodePal{pal});
+        writer.literal(frame.data(), frame.size());
     }
 
     // DecodeFrameType1 returns an image after decoding the frame in the following
@@ -383,7 +445,7 @@ namespace Cel
     //
     // Type1 corresponds to a regular CEL frame image of the specified dimensions.
     //
-    void CelDecoder::decodeFrameType1(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame)
+    void CelDecoder::decodeFrameType1(FrameBytesRef frame, FrameWriter& writer)
     {
         int32_t len = frame.size();
         for (int32_t pos = 0; pos < len;)
@@ -393,12 +455,12 @@ namespace Cel
             if (chunkSize < 0)
             {
                 // Transparent pixels.
-                decodedFrame = std::fill_n(decodedFrame, -chunkSize, Cel::Colour{0, 0, 0, false});
+                writer.transparent(-chunkSize);
             }
             else
             {
                 // Regular pixels.
-                decodedFrame = std::transform(frame.begin() + pos, frame.begin() + pos + chunkSize, decodedFrame, DecodePal{pal});
+                writer.literal(frame.data() + pos, std::min(chunkSize, len - pos));
                 pos += chunkSize;
             }
         }
@@ -454,9 +516,9 @@ namespace Cel
     //
     // Type2 corresponds to a 32x32 images of a left facing triangle.
     //
-    void CelDecoder::decodeFrameType2(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame)
+    void CelDecoder::decodeFrameType2(FrameBytesRef frame, FrameWriter& writer)
     {
-        decodeFrameType2or3(frame, pal, decodedFrame, true);
+        decodeFrameType2or3(frame, writer, true);
     }
 
     // DecodeFrameType3 returns an image after decoding the frame in the following
@@ -509,9 +571,9 @@ namespace Cel
     //    +--------------------------------+
     //
     // Type3 corresponds to a 32x32 images of a right facing triangle.
-    void CelDecoder::decodeFrameType3(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame)
+    void CelDecoder::decodeFrameType3(FrameBytesRef frame, FrameWriter& writer)
     {
-        decodeFrameType2or3(frame, pal, decodedFrame, false);
+        decodeFrameType2or3(frame, writer, false);
     }
 
     // DecodeFrameType4 returns an image after decoding the frame in the following
@@ -564,9 +626,9 @@ namespace Cel
     //    +--------------------------------+
     //
     // Type4 corresponds to a 32x32 images of a left facing trapezoid.
-    void CelDecoder::decodeFrameType4(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame)
+    void CelDecoder::decodeFrameType4(FrameBytesRef frame, FrameWriter& writer)
     {
-        decodeFrameType4or5(frame, pal, decodedFrame, true);
+        decodeFrameType4or5(frame, writer, true);
     }
 
     // DecodeFrameType5 returns an image after decoding the frame in the following
@@ -619,9 +681,9 @@ namespace Cel
     //    +--------------------------------+
     //
     // Type5 corresponds to a 32x32 images of a right facing trapezoid.
-    void CelDecoder::decodeFrameType5(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame)
+    void CelDecoder::decodeFrameType5(FrameBytesRef frame, FrameWriter& writer)
     {
-        decodeFrameType4or5(frame, pal, decodedFrame, false);
+        decodeFrameType4or5(frame, writer, false);
     }
 
     // DecodeFrameType6 returns an image after decoding the frame in the following
@@ -643,7 +705,7 @@ namespace Cel
     //    4) goto 1 until EOF is reached.
     //
     // Type6 is the only type for CL2 images.
-    void CelDecoder::decodeFrameType6(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame)
+    void CelDecoder::decodeFrameType6(FrameBytesRef frame, FrameWriter& writer)
     {
         int32_t len = frame.size();
         for (int32_t pos = 0; pos < len;)
@@ -653,7 +715,7 @@ namespace Cel
             if (chunkSize >= 0)
             {
                 // Transparent pixels.
-                decodedFrame = std::fill_n(decodedFrame, chunkSize, Cel::Colour{0, 0, 0, false});
+                writer.transparent(chunkSize);
             }
             else
             {
@@ -661,22 +723,22 @@ namespace Cel
                 if (chunkSize <= 65)
                 {
                     // Regular pixels.
-                    decodedFrame = std::transform(frame.begin() + pos, frame.begin() + pos + chunkSize, decodedFrame, DecodePal{pal});
+                    writer.literal(frame.data() + pos, std::min(chunkSize, len - pos));
                     pos += chunkSize;
                 }
                 else
                 {
                     chunkSize -= 65;
                     // Run-length encoded pixels.
-                    Colour c = pal[frame[pos]];
-                    decodedFrame = std::fill_n(decodedFrame, chunkSize, c);
+                    if (pos < len)
+                        writer.fill(frame[pos], chunkSize);
                     pos++;
                 }
             }
         }
     }
 
-    void CelDecoder::decodeFrameType2or3(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame, bool frameType2)
+    void CelDecoder::decodeFrameType2or3(FrameBytesRef frame, FrameWriter& writer, bool frameType2)
     {
         // Select line decoding function
 
@@ -721,11 +783,11 @@ namespace Cel
                 regularCount = 32 - ((row - 16) * 2);
             }
 
-            (this->*decodeLineTransparency)(&framePtr, pal, decodedFrame, regularCount);
+            (this->*decodeLineTransparency)(&framePtr, writer, regularCount);
         }
     }
 
-    void CelDecoder::decodeFrameType4or5(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame, bool frameType4)
+    void CelDecoder::decodeFrameType4or5(FrameBytesRef frame, FrameWriter& writer, bool frameType4)
     {
         // Select line decoding function
 
@@ -759,115 +821,105 @@ namespace Cel
 
             int regularCount = 2 + (row * 2);
 
-            (this->*decodeLineTransparency)(&framePtr, pal, decodedFrame, regularCount);
+            (this->*decodeLineTransparency)(&framePtr, writer, regularCount);
         }
 
         if (frame.size() > 256)
         {
-            decodedFrame = std::transform(frame.begin() + 256, frame.end(), decodedFrame, DecodePal{pal});
+            writer.literal(frame.data() + 256, frame.size() - 256);
         }
     }
 
-    void CelDecoder::decodeLineTransparencyLeft(const uint8_t** framePtr, const Pal& pal, ColoursRefIterator& decodedFrame, int regularCount)
+    void CelDecoder::decodeLineTransparencyLeft(const uint8_t** framePtr, FrameWriter& writer, int regularCount)
     {
         int transparentCount = 32 - regularCount;
 
         // Implicit transparent pixels.
-        decodedFrame = std::fill_n(decodedFrame, transparentCount, Cel::Colour{0, 0, 0, false});
+        writer.transparent(transparentCount);
 
         // Explicit regular pixels.
-        for (int i = 0; i < regularCount; i++)
-        {
-            Colour color = pal[(*framePtr)[0]];
-            *decodedFrame = color;
-            ++decodedFrame;
-            (*framePtr)++;
-        }
+        writer.literal(*framePtr, regularCount);
+        *framePtr += regularCount;
     }
 
-    void CelDecoder::decodeLineTransparencyRight(const uint8_t** framePtr, const Pal& pal, ColoursRefIterator& decodedFrame, int regularCount)
+    void CelDecoder::decodeLineTransparencyRight(const uint8_t** framePtr, FrameWriter& writer, int regularCount)
     {
         int transparentCount = 32 - regularCount;
 
         // Explicit regular pixels.
-        for (int i = 0; i < regularCount; i++)
-        {
-            Colour color = pal[(*framePtr)[0]];
-            *decodedFrame = color;
-            ++decodedFrame;
-            (*framePtr)++;
-        }
+        writer.literal(*framePtr, regularCount);
+        *framePtr += regularCount;
 
         // Transparent pixels.
 
-        decodedFrame = std::fill_n(decodedFrame, transparentCount, Cel::Colour{0, 0, 0, false});
+        writer.transparent(transparentCount);
     }
 
-    void CelDecoder::setObjcursCelDimensions(int frameNumber)
+    void CelDecoder::getObjcursCelDimensions(int frameNumber, int& width, int& height) const
     {
-        mFrameWidth = 56;
-        mFrameHeight = 84;
+        width = 56;
+        height = 84;
 
         // Width
         if (frameNumber == 0)
         {
-            mFrameWidth = 33;
+            width = 33;
         }
         else if (frameNumber > 0 && frameNumber < 10)
         {
-            mFrameWidth = 32;
+            width = 32;
         }
         else if (frameNumber == 10)
         {
-            mFrameWidth = 23;
+            width = 23;
         }
         else if (frameNumber > 10 && frameNumber < 86)
         {
-            mFrameWidth = 28;
+            width = 28;
         }
         else if (frameNumber >= 86 && frameNumber < 111)
         {
-            mFrameWidth = 56;
+            width = 56;
         }
 
         // Height
         if (frameNumber == 0)
         {
-            mFrameHeight = 29;
+            height = 29;
         }
         else if (frameNumber > 0 && frameNumber < 10)
         {
-            mFrameHeight = 32;
+            height = 32;
         }
         else if (frameNumber == 10)
         {
-            mFrameHeight = 35;
+            height = 35;
         }
         else if (frameNumber >= 11 && frameNumber < 61)
         {
-            mFrameHeight = 28;
+            height = 28;
         }
         else if (frameNumber >= 61 && frameNumber < 67)
         {
-            mFrameHeight = 56;
+            height = 56;
         }
         else if (frameNumber >= 67 && frameNumber < 86)
         {
-            mFrameHeight = 84;
+            height = 84;
         }
         else if (frameNumber >= 86 && frameNumber < 111)
         {
-            mFrameHeight = 56;
+            height = 56;
         }
     }
 
-    void CelDecoder::setCharbutCelDimensions(int frameNumber)
+    void CelDecoder::getCharbutCelDimensions(int frameNumber, int& width) const
     {
-        mFrameWidth = 41;
+        width = 41;
 
         if (frameNumber == 0)
         {
-            mFrameWidth = 95;
+            width = 95;
         }
     }
 }
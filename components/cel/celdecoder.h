@@ -5,6 +5,7 @@
 #include "pal.h"
 #include <functional>
 #include <map>
+#include <memory>
 #include <settings/settings.h>
 #include <stdint.h>
 #include <vector>
@@ -12,53 +13,59 @@
 namespace Cel
 {
     class Pal;
+    class FrameWriter;
     class CelDecoder
     {
     public:
-        CelDecoder(const std::string& celPath);
+        CelDecoder(const std::string& celPath, FrameFormat format = FrameFormat::Rgba);
+        /// Decodes every frame not decoded yet, spread across Misc::ThreadPool
         void decode();
+        /// Decodes every frame across Misc::ThreadPool into standalone RGBA buffers, without adding them to the cache
+        std::vector<RgbaFrame> decodeRgba();
         CelFrame& operator[](int32_t index);
         int32_t numFrames() const;
         int32_t animationLength() const;
 
+        /// Switches to another palette, frames already decoded as FrameFormat::Indexed are kept and just use the new colours
+        void setPalette(const std::string& palFilename);
+
     private:
         typedef std::vector<uint8_t> FrameBytes;
         typedef const std::vector<uint8_t>& FrameBytesRef;
-        typedef std::vector<Colour>& ColoursRef;
-        typedef std::vector<Colour>::iterator ColoursRefIterator;
-        typedef std::function<void(CelDecoder&, FrameBytesRef, const Pal&, ColoursRefIterator&)> FrameDecoder;
+        typedef std::function<void(CelDecoder&, FrameBytesRef, FrameWriter&)> FrameDecoder;
 
         void readConfiguration();
         void readCelName();
         void readPalette();
 
         void getFrames();
-        void decodeFrame(int32_t index, FrameBytesRef frame, CelFrame& celFrame);
+        void decodeFrame(int32_t index, FrameBytesRef frame, CelFrame& celFrame, FrameFormat format);
         FrameDecoder getFrameDecoder(const std::string& celName, FrameBytesRef frame, int frameNumber);
         bool isType0(const std::string& celName, int frameNumber);
         bool isType2or4(FrameBytesRef frame);
         bool isType3or5(FrameBytesRef frame);
 
-        void decodeFrameType0(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame);
-        void decodeFrameType1(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame);
-        void decodeFrameType2(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame);
-        void decodeFrameType3(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame);
-        void decodeFrameType4(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame);
-        void decodeFrameType5(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame);
-        void decodeFrameType6(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame);
-        void decodeFrameType2or3(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame, bool frameType2);
-        void decodeFrameType4or5(FrameBytesRef frame, const Pal& pal, ColoursRefIterator& decodedFrame, bool frameType4);
+        void decodeFrameType0(FrameBytesRef frame, FrameWriter& writer);
+        void decodeFrameType1(FrameBytesRef frame, FrameWriter& writer);
+        void decodeFrameType2(FrameBytesRef frame, FrameWriter& writer);
+        void decodeFrameType3(FrameBytesRef frame, FrameWriter& writer);
+        void decodeFrameType4(FrameBytesRef frame, FrameWriter& writer);
+        void decodeFrameType5(FrameBytesRef frame, FrameWriter& writer);
+        void decodeFrameType6(FrameBytesRef frame, FrameWriter& writer);
+        void decodeFrameType2or3(FrameBytesRef frame, FrameWriter& writer, bool frameType2);
+        void decodeFrameType4or5(FrameBytesRef frame, FrameWriter& writer, bool frameType4);
 
-        void decodeLineTransparencyLeft(const uint8_t** framePtr, const Pal& pal, ColoursRefIterator& decodedFrame, int);
-        void decodeLineTransparencyRight(const uint8_t** framePtr, const Pal& pal, ColoursRefIterator& decodedFrame, int);
-        void setObjcursCelDimensions(int frame);
-        void setCharbutCelDimensions(int frame);
+        void decodeLineTransparencyLeft(const uint8_t** framePtr, FrameWriter& writer, int);
+        void decodeLineTransparencyRight(const uint8_t** framePtr, FrameWriter& writer, int);
+        void getObjcursCelDimensions(int frame, int& width, int& height) const;
+        void getCharbutCelDimensions(int frame, int& width) const;
 
         std::vector<FrameBytes> mFrames;
         std::map<int32_t, CelFrame> mCache;
         std::string mCelPath;
         std::string mCelName;
-        Pal mPal;
+        std::shared_ptr<const Pal> mPal;
+        FrameFormat mFormat;
         bool mIsCl2;
         bool mIsObjcursCel;
         bool mIsCharbutCel;
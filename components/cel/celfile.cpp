@@ -4,11 +4,15 @@
 
 namespace Cel
 {
-    CelFile::CelFile(const std::string& filename) : mDecoder(filename) {}
+    CelFile::CelFile(const std::string& filename, FrameFormat format) : mDecoder(filename, format) {}
 
     int32_t CelFile::numFrames() const { return mDecoder.numFrames(); }
 
     int32_t CelFile::animLength() const { return mDecoder.animationLength(); }
 
     CelFrame& CelFile::operator[](int32_t index) { return mDecoder[index]; }
+
+    std::vector<RgbaFrame> CelFile::decodeRgba() { return mDecoder.decodeRgba(); }
+
+    void CelFile::setPalette(const std::string& palFilename) { mDecoder.setPalette(palFilename); }
 }
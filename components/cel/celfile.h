@@ -15,13 +15,18 @@ namespace Cel
     class CelFile
     {
     public:
-        CelFile(const std::string& filename);
+        CelFile(const std::string& filename, FrameFormat format = FrameFormat::Rgba);
 
         // If normal cel file, returns same as numFrames(), for an archive, the number of frames in each subcel
         int32_t animLength() const;
         int32_t numFrames() const;
         CelFrame& operator[](int32_t index);
 
+        /// All frames as RGBA, decoded in parallel. Meant for loading textures, where the frames aren't needed afterwards.
+        std::vector<RgbaFrame> decodeRgba();
+
+        void setPalette(const std::string& palFilename);
+
     private:
         CelDecoder mDecoder;
     };
@@ -1,9 +1,52 @@
 #include "celframe.h"
 #include "pal.h"
+#include <algorithm>
 
 namespace Cel
 {
-    const Colour& get(int32_t x, int32_t y, const CelFrame& frame) { return frame.mRawImage.data()[x + (frame.mHeight - 1 - y) * frame.mWidth]; }
+    namespace
+    {
+        const Colour transparent(0, 0, 0, false);
+    }
+
+    const Colour& get(int32_t x, int32_t y, const CelFrame& frame)
+    {
+        int32_t i = x + (frame.mHeight - 1 - y) * frame.mWidth;
+
+        if (!frame.isIndexed())
+            return frame.mRawImage.data()[i];
+
+        if (frame.mVisibleMask[i / 8] & (1 << (i % 8)))
+            return (*frame.mPal)[frame.mIndices[i]];
+
+        return transparent;
+    }
 
     Misc::Helper2D<const CelFrame, const Colour&> CelFrame::operator[](int32_t x) const { return Misc::Helper2D<const CelFrame, const Colour&>(*this, x, get); }
+
+    std::vector<Colour> CelFrame::toRgba() const
+    {
+        std::vector<Colour> retval(mWidth * mHeight, transparent);
+
+        for (int32_t y = 0; y < mHeight; y++)
+        {
+            Colour* dest = retval.data() + y * mWidth;
+            int32_t row = (mHeight - 1 - y) * mWidth;
+
+            if (!isIndexed())
+            {
+                std::copy(mRawImage.begin() + row, mRawImage.begin() + row + mWidth, dest);
+                continue;
+            }
+
+            for (int32_t x = 0; x < mWidth; x++)
+            {
+                int32_t i = row + x;
+                if (mVisibleMask[i / 8] & (1 << (i % 8)))
+                    dest[x] = (*mPal)[mIndices[i]];
+            }
+        }
+
+        return retval;
+    }
 }
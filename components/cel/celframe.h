@@ -1,6 +1,7 @@
 #ifndef CEL_FRAME_H
 #define CEL_FRAME_H
 
+#include <memory>
 #include <misc/helper2d.h>
 #include <stdint.h>
 #include <vector>
@@ -8,8 +9,23 @@
 namespace Cel
 {
     struct Colour;
+    class Pal;
     class CelFile;
 
+    enum class FrameFormat
+    {
+        Rgba,   ///< one Colour per pixel, expanded at decode time
+        Indexed ///< one palette index per pixel plus a transparency bitmask, expanded when the pixels are needed
+    };
+
+    /// Top down RGBA8 copy of a frame, ready to upload as a texture
+    struct RgbaFrame
+    {
+        int32_t width = 0;
+        int32_t height = 0;
+        std::vector<uint8_t> pixels; ///< r, g, b, a for each pixel, alpha is 0 or 255
+    };
+
     class CelFrame
     {
     public:
@@ -18,12 +34,23 @@ namespace Cel
 
         Misc::Helper2D<const CelFrame, const Colour&> operator[](int32_t x) const;
 
+        bool isIndexed() const { return mPal != nullptr; }
+
+        /// @return the frame as RGBA, one row after another starting from the top row
+        std::vector<Colour> toRgba() const;
+
     private:
         friend class CelFile;
         friend class CelDecoder;
+        friend class FrameWriter;
         friend const Colour& get(int32_t x, int32_t y, const CelFrame& frame);
 
-        std::vector<Colour> mRawImage;
+        // Both layouts store the rows bottom up, the order the decoders produce them in
+        std::vector<Colour> mRawImage; ///< FrameFormat::Rgba only
+
+        std::vector<uint8_t> mIndices;     ///< FrameFormat::Indexed only
+        std::vector<uint8_t> mVisibleMask; ///< FrameFormat::Indexed only, bit (i % 8) of byte (i / 8) is set if pixel i is visible
+        std::shared_ptr<const Pal> mPal;   ///< FrameFormat::Indexed only, can be swapped without touching the indices
     };
 }
 
@@ -0,0 +1,254 @@
+#include "framewriter.h"
+#include "pal.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FA_CEL_SSE2
+#include <emmintrin.h>
+#endif
+
+// The AVX2 kernels are compiled with a target attribute and only picked after checking the CPU at runtime,
+// so the rest of the build doesn't need -mavx2. MSVC has no equivalent of the attribute, so it stays on SSE2.
+#if defined(FA_CEL_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define FA_CEL_AVX2
+#include <immintrin.h>
+#endif
+
+namespace Cel
+{
+    static_assert(sizeof(Colour) == sizeof(uint32_t), "the kernels treat a Colour as one 32 bit value");
+
+    namespace
+    {
+        void literalScalar(Colour* dest, const uint8_t* indices, const Colour* pal, int32_t count)
+        {
+            for (int32_t i = 0; i < count; i++)
+                dest[i] = pal[indices[i]];
+        }
+
+        void fillScalar(Colour* dest, Colour colour, int32_t count) { std::fill_n(dest, count, colour); }
+
+#ifdef FA_CEL_SSE2
+        int32_t asInt(Colour colour)
+        {
+            int32_t retval;
+            memcpy(&retval, &colour, sizeof(retval));
+            return retval;
+        }
+
+        // SSE2 has no gather, but assembling four pixels in a register still beats four separate 32 bit stores
+        void literalSse2(Colour* dest, const uint8_t* indices, const Colour* pal, int32_t count)
+        {
+            int32_t i = 0;
+
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128i pixels = _mm_setr_epi32(asInt(pal[indices[i]]), asInt(pal[indices[i + 1]]), asInt(pal[indices[i + 2]]), asInt(pal[indices[i + 3]]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), pixels);
+            }
+
+            literalScalar(dest + i, indices + i, pal, count - i);
+        }
+
+        void fillSse2(Colour* dest, Colour colour, int32_t count)
+        {
+            __m128i pixels = _mm_set1_epi32(asInt(colour));
+            int32_t i = 0;
+
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), pixels);
+
+            fillScalar(dest + i, colour, count - i);
+        }
+#endif
+
+#ifdef FA_CEL_AVX2
+        __attribute__((target("avx2"))) void literalAvx2(Colour* dest, const uint8_t* indices, const Colour* pal, int32_t count)
+        {
+            const int* table = reinterpret_cast<const int*>(pal);
+            int32_t i = 0;
+
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256i offsets = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i)));
+                __m256i pixels = _mm256_i32gather_epi32(table, offsets, 4);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), pixels);
+            }
+
+            // Tails are done here rather than by calling the SSE2 kernels, jumping into non VEX code with the upper halves
+            // of the ymm registers dirty costs far more than the gather saves
+            for (; i < count; i++)
+                dest[i] = pal[indices[i]];
+        }
+
+        __attribute__((target("avx2"))) void fillAvx2(Colour* dest, Colour colour, int32_t count)
+        {
+            __m256i pixels = _mm256_set1_epi32(asInt(colour));
+            int32_t i = 0;
+
+            for (; i + 8 <= count; i += 8)
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), pixels);
+
+            for (; i < count; i++)
+                dest[i] = colour;
+        }
+#endif
+
+        FrameWriter::Simd detectSimd()
+        {
+#ifdef FA_CEL_AVX2
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return FrameWriter::Simd::Avx2;
+#endif
+#ifdef FA_CEL_SSE2
+            return FrameWriter::Simd::Sse2;
+#else
+            return FrameWriter::Simd::None;
+#endif
+        }
+
+        std::atomic<FrameWriter::Simd>& currentSimd()
+        {
+            static std::atomic<FrameWriter::Simd> simd(FrameWriter::bestSimd());
+            return simd;
+        }
+    }
+
+    struct FrameWriter::Kernels
+    {
+        void (*literal)(Colour* dest, const uint8_t* indices, const Colour* pal, int32_t count);
+        void (*fill)(Colour* dest, Colour colour, int32_t count);
+    };
+
+    FrameWriter::Simd FrameWriter::bestSimd()
+    {
+        static const Simd best = detectSimd();
+        return best;
+    }
+
+    void FrameWriter::setSimd(Simd simd) { currentSimd() = std::min(simd, bestSimd()); }
+
+    FrameWriter::Simd FrameWriter::getSimd() { return currentSimd(); }
+
+    FrameWriter::FrameWriter(CelFrame& frame, const Pal& pal)
+        : mPal(pal), mKernels(nullptr), mRgba(nullptr), mIndices(nullptr), mVisibleMask(nullptr), mPos(0), mEnd(frame.mWidth * frame.mHeight)
+    {
+        static const Kernels scalar = {literalScalar, fillScalar};
+#ifdef FA_CEL_SSE2
+        static const Kernels sse2 = {literalSse2, fillSse2};
+#endif
+#ifdef FA_CEL_AVX2
+        static const Kernels avx2 = {literalAvx2, fillAvx2};
+#endif
+
+        switch (getSimd())
+        {
+#ifdef FA_CEL_AVX2
+            case Simd::Avx2:
+                mKernels = &avx2;
+                break;
+#endif
+#ifdef FA_CEL_SSE2
+            case Simd::Sse2:
+                mKernels = &sse2;
+                break;
+#endif
+            default:
+                mKernels = &scalar;
+                break;
+        }
+
+        if (frame.isIndexed())
+        {
+            mIndices = frame.mIndices.data();
+            mVisibleMask = frame.mVisibleMask.data();
+        }
+        else
+        {
+            mRgba = frame.mRawImage.data();
+        }
+    }
+
+    int32_t FrameWriter::clamp(int32_t count) const { return std::max(0, std::min(count, mEnd - mPos)); }
+
+    void FrameWriter::literal(const uint8_t* indices, int32_t count)
+    {
+        count = clamp(count);
+
+        if (mRgba)
+        {
+            mKernels->literal(mRgba + mPos, indices, &mPal[0], count);
+        }
+        else
+        {
+            memcpy(mIndices + mPos, indices, count);
+            setVisible(count, true);
+        }
+
+        mPos += count;
+    }
+
+    void FrameWriter::fill(uint8_t index, int32_t count)
+    {
+        count = clamp(count);
+
+        if (mRgba)
+        {
+            mKernels->fill(mRgba + mPos, mPal[index], count);
+        }
+        else
+        {
+            memset(mIndices + mPos, index, count);
+            setVisible(count, true);
+        }
+
+        mPos += count;
+    }
+
+    void FrameWriter::transparent(int32_t count)
+    {
+        count = clamp(count);
+
+        if (mRgba)
+        {
+            mKernels->fill(mRgba + mPos, Colour{0, 0, 0, false}, count);
+        }
+        else
+        {
+            memset(mIndices + mPos, 0, count);
+            setVisible(count, false);
+        }
+
+        mPos += count;
+    }
+
+    void FrameWriter::setVisible(int32_t count, bool visible)
+    {
+        int32_t i = mPos;
+        int32_t end = mPos + count;
+
+        // Bit at a time up to a byte boundary, then whole bytes, then the remaining bits
+        for (; i < end && i % 8 != 0; i++)
+        {
+            if (visible)
+                mVisibleMask[i / 8] |= 1 << (i % 8);
+            else
+                mVisibleMask[i / 8] &= ~(1 << (i % 8));
+        }
+
+        int32_t wholeBytes = (end - i) / 8;
+        memset(mVisibleMask + i / 8, visible ? 0xFF : 0x00, wholeBytes);
+        i += wholeBytes * 8;
+
+        for (; i < end; i++)
+        {
+            if (visible)
+                mVisibleMask[i / 8] |= 1 << (i % 8);
+            else
+                mVisibleMask[i / 8] &= ~(1 << (i % 8));
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef CEL_FRAME_WRITER_H
+#define CEL_FRAME_WRITER_H
+
+#include "celframe.h"
+#include <stdint.h>
+
+namespace Cel
+{
+    ///
+    /// Output side of the frame decoders. The decoders only describe runs of pixels,
+    /// this writes them into the frame in whichever FrameFormat it was set up with.
+    /// Runs that would go past the end of the frame are cut short.
+    ///
+    class FrameWriter
+    {
+    public:
+        /// Instruction sets the RGBA palette lookup and fill kernels can use
+        enum class Simd
+        {
+            None,
+            Sse2,
+            Avx2
+        };
+
+        /// @return the best instruction set this build and CPU support, used by default
+        static Simd bestSimd();
+        /// Only meant for tests and benchmarks, applies to writers created after the call
+        static void setSimd(Simd simd);
+        static Simd getSimd();
+
+        FrameWriter(CelFrame& frame, const Pal& pal);
+
+        /// count regular pixels, one palette index each
+        void literal(const uint8_t* indices, int32_t count);
+        /// count regular pixels, all with the same palette index
+        void fill(uint8_t index, int32_t count);
+        void transparent(int32_t count);
+
+        int32_t position() const { return mPos; }
+
+    private:
+        struct Kernels;
+
+        int32_t clamp(int32_t count) const;
+        void setVisible(int32_t count, bool visible);
+
+        const Pal& mPal;
+        const Kernels* mKernels;
+        Colour* mRgba;
+        uint8_t* mIndices;
+        uint8_t* mVisibleMask;
+        int32_t mPos;
+        int32_t mEnd;
+    };
+}
+
+#endif
@@ -1,5 +1,5 @@
 #include "pal.h"
-#include <faio/fafileobject.h>
+#include <faio/faio.h>
 #include <stdio.h>
 
 namespace Cel
@@ -8,13 +8,15 @@ namespace Cel
 
     Pal::Pal(const std::string& filename) : Pal()
     {
-        FAIO::FAFileObject pal_file(filename);
+        FAIO::FileBufferPtr pal_file = FAIO::readAll(filename);
+        if (!pal_file)
+            return;
 
         for (int i = 0; i < 256; i++)
         {
-            pal_file.FAfread(&contents[i].r, 1, 1);
-            pal_file.FAfread(&contents[i].g, 1, 1);
-            pal_file.FAfread(&contents[i].b, 1, 1);
+            contents[i].r = pal_file->read8(i * 3);
+            contents[i].g = pal_file->read8(i * 3 + 1);
+            contents[i].b = pal_file->read8(i * 3 + 2);
         }
     }
 
@@ -83,25 +83,19 @@ namespace DiabloExe
 
     std::string DiabloExe::getMD5(const std::string& pathEXE)
     {
-        FAIO::FAFileObject dexe(pathEXE);
-        if (!dexe.isValid())
+        FAIO::FileBufferPtr dexe = FAIO::readAll(pathEXE);
+        if (!dexe)
         {
             return std::string();
         }
 
-        size_t size = dexe.FAsize();
-        Misc::md5_byte_t* buff = new Misc::md5_byte_t[size];
-        dexe.FAfread(buff, sizeof(Misc::md5_byte_t), size);
-
         Misc::md5_state_t state;
         Misc::md5_byte_t digest[16];
 
         md5_init(&state);
-        md5_append(&state, buff, size);
+        md5_append(&state, dexe->data(), dexe->size());
         md5_finish(&state, digest);
 
-        delete[] buff;
-
         std::stringstream s;
 
         for (size_t i = 0; i < 16; i++)
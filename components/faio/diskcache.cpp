@@ -0,0 +1,258 @@
+#include "diskcache.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+namespace bfs = boost::filesystem;
+
+namespace FAIO
+{
+    bool DiskCache::open(const std::string& directory, const std::string& archiveKey, uint64_t maxBytes)
+    {
+        close();
+
+        if (directory.empty() || archiveKey.empty() || maxBytes == 0)
+            return false;
+
+        boost::system::error_code error;
+        bfs::path root(directory);
+
+        // Anything cached for a different archive is useless now. The directory is a user setting and could be somewhere
+        // with other things in it, so only what looks like one of our archive directories is removed.
+        if (bfs::is_directory(root, error))
+        {
+            for (bfs::directory_iterator it(root, error), end; !error && it != end; it.increment(error))
+            {
+                if (it->path().filename() != archiveKey && isArchiveDirectory(it->path()))
+                    bfs::remove_all(it->path(), error);
+            }
+        }
+
+        root /= archiveKey;
+        bfs::create_directories(root, error);
+        if (error)
+        {
+            std::cerr << "Failed to create asset cache directory " << root << ": " << error.message() << std::endl;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mRoot = root;
+        mMaxBytes = maxBytes;
+
+        for (bfs::recursive_directory_iterator it(root, error), end; !error && it != end; it.increment(error))
+        {
+            if (!bfs::is_regular_file(it->path()))
+                continue;
+
+            // left behind by a crash in the middle of put()
+            if (it->path().extension() == ".tmp")
+            {
+                bfs::remove(it->path(), error);
+                continue;
+            }
+
+            std::string relative = it->path().generic_string().substr(root.generic_string().size() + 1);
+
+            Entry entry;
+            entry.size = bfs::file_size(it->path(), error);
+            entry.lastUse = bfs::last_write_time(it->path(), error);
+
+            mEntries[relative] = entry;
+            mTotalBytes += entry.size;
+        }
+
+        prune();
+
+        std::cout << "Using asset cache " << mRoot << ", " << mEntries.size() << " files, " << mTotalBytes / (1024 * 1024) << "MB" << std::endl;
+
+        return true;
+    }
+
+    void DiskCache::close()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mRoot.clear();
+        mMaxBytes = 0;
+        mTotalBytes = 0;
+        mEntries.clear();
+    }
+
+    bool DiskCache::isOpen() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mMaxBytes != 0;
+    }
+
+    bool DiskCache::isArchiveDirectory(const bfs::path& path)
+    {
+        // Named after an MPQ fingerprint, see MpqArchive::fingerprint()
+        std::string name = path.filename().string();
+        if (name.size() != 32)
+            return false;
+
+        for (char c : name)
+        {
+            if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+                return false;
+        }
+
+        boost::system::error_code error;
+        return bfs::is_directory(path, error);
+    }
+
+    std::string DiskCache::normalise(const std::string& path)
+    {
+        std::string retval = path;
+
+        for (size_t i = 0; i < retval.size(); i++)
+        {
+            if (retval[i] == '\\')
+                retval[i] = '/';
+            else if (retval[i] >= 'A' && retval[i] <= 'Z')
+                retval[i] += 'a' - 'A';
+        }
+
+        // Never let a path escape the cache directory
+        if (retval.empty() || retval[0] == '/' || retval.find("..") != std::string::npos)
+            return "";
+
+        return retval;
+    }
+
+    bool DiskCache::contains(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mEntries.count(normalise(path)) != 0;
+    }
+
+    FileBufferPtr DiskCache::get(const std::string& path)
+    {
+        std::string key = normalise(path);
+        bfs::path filePath;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            auto it = mEntries.find(key);
+            if (it == mEntries.end())
+                return nullptr;
+
+            // The modification time doubles as the LRU timestamp, so it survives restarts
+            it->second.lastUse = std::time(nullptr);
+            filePath = mRoot / key;
+
+            boost::system::error_code error;
+            bfs::last_write_time(filePath, it->second.lastUse, error);
+        }
+
+        FileBufferPtr buffer = FileBuffer::fromFile(filePath.string());
+
+        if (!buffer)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            auto it = mEntries.find(key);
+            if (it != mEntries.end())
+            {
+                mTotalBytes -= it->second.size;
+                mEntries.erase(it);
+            }
+        }
+
+        return buffer;
+    }
+
+    void DiskCache::put(const std::string& path, const uint8_t* data, size_t size)
+    {
+        std::string key = normalise(path);
+        bfs::path filePath;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mMaxBytes == 0 || key.empty() || size > mMaxBytes)
+                return;
+
+            filePath = mRoot / key;
+        }
+
+        boost::system::error_code error;
+        bfs::path tmpPath = filePath.parent_path() / bfs::unique_path("%%%%-%%%%-%%%%.tmp");
+
+        bfs::create_directories(filePath.parent_path(), error);
+
+        // Write to a temporary file and rename it into place, so a partially written file is never picked up
+        {
+            std::ofstream out(tmpPath.string().c_str(), std::ios::binary);
+            out.write(reinterpret_cast<const char*>(data), size);
+
+            if (!out.good())
+            {
+                out.close();
+                bfs::remove(tmpPath, error);
+                return;
+            }
+        }
+
+        bfs::rename(tmpPath, filePath, error);
+        if (error)
+        {
+            bfs::remove(tmpPath, error);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        // closed while we were writing
+        if (mMaxBytes == 0)
+            return;
+
+        auto it = mEntries.find(key);
+        if (it != mEntries.end())
+            mTotalBytes -= it->second.size;
+
+        Entry entry;
+        entry.size = size;
+        entry.lastUse = std::time(nullptr);
+
+        mEntries[key] = entry;
+        mTotalBytes += size;
+
+        prune();
+    }
+
+    void DiskCache::prune()
+    {
+        if (mTotalBytes <= mMaxBytes)
+            return;
+
+        std::vector<std::pair<std::time_t, std::string>> byAge;
+        byAge.reserve(mEntries.size());
+
+        for (const auto& entry : mEntries)
+            byAge.push_back(std::make_pair(entry.second.lastUse, entry.first));
+
+        std::sort(byAge.begin(), byAge.end());
+
+        // Go a bit below the limit, so we don't end up pruning again on every put
+        uint64_t target = mMaxBytes - mMaxBytes / 10;
+
+        for (size_t i = 0; i < byAge.size() && mTotalBytes > target; i++)
+        {
+            boost::system::error_code error;
+
+            // This can fail if the file is still mapped on windows, it'll be tried again next time
+            if (bfs::remove(mRoot / byAge[i].second, error) && !error)
+            {
+                mTotalBytes -= mEntries[byAge[i].second].size;
+                mEntries.erase(byAge[i].second);
+            }
+        }
+    }
+}
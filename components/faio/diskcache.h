@@ -0,0 +1,50 @@
+#ifndef FAIO_DISKCACHE_H
+#define FAIO_DISKCACHE_H
+
+#include "faio.h"
+
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <boost/filesystem/path.hpp>
+
+namespace FAIO
+{
+    /// Persistent cache of decompressed MPQ files, so later runs can just map them instead of decompressing again.
+    /// Files live under <directory>/<archive fingerprint>/<path in MPQ>, so a different MPQ never sees stale data.
+    /// When the total size goes over the limit, the least recently used files are deleted.
+    class DiskCache
+    {
+    public:
+        bool open(const std::string& directory, const std::string& archiveKey, uint64_t maxBytes);
+        void close();
+        bool isOpen() const;
+
+        bool contains(const std::string& path);
+
+        /// @return the cached contents of path, or nullptr if it isn't cached
+        FileBufferPtr get(const std::string& path);
+        void put(const std::string& path, const uint8_t* data, size_t size);
+
+    private:
+        struct Entry
+        {
+            uint64_t size;
+            std::time_t lastUse;
+        };
+
+        static std::string normalise(const std::string& path);
+        static bool isArchiveDirectory(const boost::filesystem::path& path);
+        void prune();
+
+        mutable std::mutex mMutex;
+        boost::filesystem::path mRoot;
+        uint64_t mMaxBytes = 0;
+        uint64_t mTotalBytes = 0;
+        std::map<std::string, Entry> mEntries; ///< keyed by normalised path
+    };
+}
+
+#endif
@@ -1,11 +1,20 @@
 #include "faio.h"
+#include "diskcache.h"
+#include "mpqarchive.h"
+#include "prefetcher.h"
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstring>
 #include <iostream>
 #include <mutex>
+#include <thread>
 
 namespace bfs = boost::filesystem;
+namespace bip = boost::interprocess;
 
 // We don't want warnings from StormLibs headers
 #include <StormLib.h>
@@ -16,7 +25,15 @@ namespace FAIO
 {
     FAFile::FAFile() {}
 
+    struct MemoryFile
+    {
+        FileBufferPtr buffer;
+        size_t pos;
+    };
+
     const std::string DIABDAT_MPQ = "DIABDAT.MPQ";
+
+    // Only needed for the StormLib fallback, reads through mappedDiabdat are lock free
     std::mutex m;
 
     // StormLib needs paths with windows style \'s
@@ -35,6 +52,44 @@ namespace FAIO
     }
 
     HANDLE diabdat = NULL;
+    MpqArchive mappedDiabdat;
+    DiskCache diskCache;
+    std::unique_ptr<Prefetcher> prefetcher;
+
+    const size_t PREFETCH_CACHE_SIZE = 64 * 1024 * 1024;
+
+    FileBufferPtr readAllDirect(const std::string& filename);
+
+    // Returns the whole decompressed file, going through the disk cache if it is enabled
+    FileBufferPtr readMappedMpqFile(const std::string& stormPath)
+    {
+        if (diskCache.isOpen())
+        {
+            if (FileBufferPtr cached = diskCache.get(stormPath))
+                return cached;
+        }
+
+        const MpqArchive::BlockEntry* block = mappedDiabdat.find(stormPath);
+        if (!block)
+            return nullptr;
+
+        MpqFile mpqFile(mappedDiabdat, *block, stormPath);
+        if (!mpqFile.open())
+            return nullptr;
+
+        // Stored files are already usable straight from the mapping, no point in caching them
+        if (const uint8_t* stored = mpqFile.storedData())
+            return std::make_shared<FileBuffer>(mappedDiabdat.mapping(), stored, mpqFile.size());
+
+        std::shared_ptr<std::vector<uint8_t>> contents = std::make_shared<std::vector<uint8_t>>(mpqFile.size());
+        if (mpqFile.read(contents->data(), contents->size()) != contents->size())
+            return nullptr;
+
+        if (diskCache.isOpen())
+            diskCache.put(stormPath, contents->data(), contents->size());
+
+        return std::make_shared<FileBuffer>(contents, contents->data(), contents->size());
+    }
 
     bool init(const std::string pathMPQ, const std::string listFile)
     {
@@ -54,9 +109,28 @@ namespace FAIO
         if (!listFile.empty())
             SFileAddListFile(diabdat, listFile.c_str());
 
+        // StormLib stays open for listMpqFiles, and as a fallback if we can't parse the archive ourselves
+        if (success && !mappedDiabdat.open(pathMPQ))
+            std::cerr << "Failed to map " << pathMPQ << ", falling back to StormLib for all reads" << std::endl;
+
+        // Leave a core for each of the game and render threads
+        size_t workerCount = std::max(1, std::min(4, int32_t(std::thread::hardware_concurrency()) - 2));
+        prefetcher.reset(new Prefetcher(readAllDirect, workerCount, PREFETCH_CACHE_SIZE));
+
         return success;
     }
 
+    bool initDiskCache(const std::string& directory, uint64_t maxBytes)
+    {
+        if (!mappedDiabdat.isOpen())
+        {
+            std::cerr << "Asset cache needs the MPQ to be mapped, not using it" << std::endl;
+            return false;
+        }
+
+        return diskCache.open(directory, mappedDiabdat.fingerprint(), maxBytes);
+    }
+
     std::vector<std::string> listMpqFiles(const std::string& pattern)
     {
         SFILE_FIND_DATA findFileData;
@@ -78,6 +152,18 @@ namespace FAIO
 
     void quit()
     {
+        if (prefetcher)
+        {
+            PrefetchStats stats = prefetcher->stats();
+            std::cout << "Prefetch: " << stats.hits << " hits, " << stats.lateHits << " late hits, " << stats.misses << " misses, " << stats.loads
+                      << " loads, " << stats.evictions << " evictions" << std::endl;
+
+            prefetcher.reset();
+        }
+
+        diskCache.close();
+        mappedDiabdat.close();
+
         if (NULL != diabdat)
         {
             SFileCloseArchive(diabdat);
@@ -92,6 +178,12 @@ namespace FAIO
         if (bfs::exists(filename))
             return true;
 
+        if (mappedDiabdat.isOpen())
+        {
+            std::string stormPath = getStormLibPath(path);
+            return (diskCache.isOpen() && diskCache.contains(stormPath)) || mappedDiabdat.find(stormPath) != nullptr;
+        }
+
         std::lock_guard<std::mutex> lock(m);
         std::string stormPath = getStormLibPath(path);
 
@@ -103,7 +195,50 @@ namespace FAIO
         bfs::path path(filename);
         path.make_preferred();
 
-        if (!bfs::exists(filename))
+        if (!bfs::exists(filename) && diskCache.isOpen())
+        {
+            FileBufferPtr buffer = readMappedMpqFile(getStormLibPath(path));
+
+            if (!buffer)
+            {
+                std::cerr << "File " << path << " not found" << std::endl;
+                return NULL;
+            }
+
+            FAFile* file = new FAFile();
+            file->mode = FAFile::MemoryFile;
+            file->data.memoryFile = new MemoryFile();
+            file->data.memoryFile->buffer = buffer;
+            file->data.memoryFile->pos = 0;
+
+            return file;
+        }
+        else if (!bfs::exists(filename) && mappedDiabdat.isOpen())
+        {
+            std::string stormPath = getStormLibPath(path);
+            const MpqArchive::BlockEntry* block = mappedDiabdat.find(stormPath);
+
+            if (!block)
+            {
+                std::cerr << "File " << path << " not found" << std::endl;
+                return NULL;
+            }
+
+            MpqFile* mpqFile = new MpqFile(mappedDiabdat, *block, stormPath);
+            if (!mpqFile->open())
+            {
+                std::cerr << "Failed to open " << filename << " in " << DIABDAT_MPQ << std::endl;
+                delete mpqFile;
+                return NULL;
+            }
+
+            FAFile* file = new FAFile();
+            file->mode = FAFile::MappedMPQFile;
+            file->data.mappedMpqFile = mpqFile;
+
+            return file;
+        }
+        else if (!bfs::exists(filename))
         {
             std::lock_guard<std::mutex> lock(m);
             std::string stormPath = getStormLibPath(path);
@@ -170,6 +305,21 @@ namespace FAIO
 
                 return dwBytes;
             }
+
+            case FAFile::MappedMPQFile:
+                return size ? stream->data.mappedMpqFile->read(ptr, size * count) / size : 0;
+
+            case FAFile::MemoryFile:
+            {
+                MemoryFile* memoryFile = stream->data.memoryFile;
+                size_t available = memoryFile->pos < memoryFile->buffer->size() ? memoryFile->buffer->size() - memoryFile->pos : 0;
+                size_t items = size ? std::min(count, available / size) : 0;
+
+                memcpy(ptr, memoryFile->buffer->data() + memoryFile->pos, items * size);
+                memoryFile->pos += items * size;
+
+                return items;
+            }
         }
         return 0;
     }
@@ -199,6 +349,18 @@ namespace FAIO
 
                 break;
             }
+
+            case FAFile::MappedMPQFile:
+            {
+                delete stream->data.mappedMpqFile;
+                break;
+            }
+
+            case FAFile::MemoryFile:
+            {
+                delete stream->data.memoryFile;
+                break;
+            }
         }
 
         delete stream;
@@ -242,6 +404,39 @@ namespace FAIO
 
                 return nError != ERROR_SUCCESS;
             }
+
+            case FAFile::MappedMPQFile:
+                return stream->data.mappedMpqFile->seek(static_cast<int64_t>(offset), origin);
+
+            case FAFile::MemoryFile:
+            {
+                MemoryFile* memoryFile = stream->data.memoryFile;
+                int64_t base;
+
+                switch (origin)
+                {
+                    case SEEK_SET:
+                        base = 0;
+                        break;
+
+                    case SEEK_CUR:
+                        base = memoryFile->pos;
+                        break;
+
+                    case SEEK_END:
+                        base = memoryFile->buffer->size();
+                        break;
+
+                    default:
+                        return 1; // error, incorrect origin
+                }
+
+                if (base + static_cast<int64_t>(offset) < 0)
+                    return 1;
+
+                memoryFile->pos = base + static_cast<int64_t>(offset);
+                return 0;
+            }
         }
 
         return 0;
@@ -260,6 +455,12 @@ namespace FAIO
                 return SFileSetFilePointer(*((HANDLE*)stream->data.mpqFile), 0, NULL, FILE_CURRENT);
             }
 
+            case FAFile::MappedMPQFile:
+                return stream->data.mappedMpqFile->tell();
+
+            case FAFile::MemoryFile:
+                return stream->data.memoryFile->pos;
+
             default:
                 return 0;
         }
@@ -277,11 +478,125 @@ namespace FAIO
                 std::lock_guard<std::mutex> lock(m);
                 return SFileGetFileSize(*((HANDLE*)stream->data.mpqFile), NULL);
             }
+
+            case FAFile::MappedMPQFile:
+                return stream->data.mappedMpqFile->size();
+
+            case FAFile::MemoryFile:
+                return stream->data.memoryFile->buffer->size();
         }
 
         return 0;
     }
 
+    FileBuffer::FileBuffer(std::shared_ptr<const void> owner, const uint8_t* data, size_t size) : mOwner(owner), mData(data), mSize(size) {}
+
+    uint32_t FileBuffer::read32(size_t offset) const
+    {
+        uint32_t tmp = 0;
+        if (offset + sizeof(tmp) <= mSize)
+            memcpy(&tmp, mData + offset, sizeof(tmp));
+        return tmp;
+    }
+
+    uint16_t FileBuffer::read16(size_t offset) const
+    {
+        uint16_t tmp = 0;
+        if (offset + sizeof(tmp) <= mSize)
+            memcpy(&tmp, mData + offset, sizeof(tmp));
+        return tmp;
+    }
+
+    uint8_t FileBuffer::read8(size_t offset) const { return offset < mSize ? mData[offset] : 0; }
+
+    FileBufferPtr FileBuffer::fromFile(const std::string& path)
+    {
+        try
+        {
+            bip::file_mapping mapping(path.c_str(), bip::read_only);
+            std::shared_ptr<bip::mapped_region> region = std::make_shared<bip::mapped_region>(mapping, bip::read_only);
+            return std::make_shared<FileBuffer>(region, static_cast<const uint8_t*>(region->get_address()), region->get_size());
+        }
+        catch (const bip::interprocess_exception& e)
+        {
+            std::cerr << "Failed to map " << path << ": " << e.what() << std::endl;
+            return nullptr;
+        }
+    }
+
+    FileBufferPtr readAll(const std::string& filename)
+    {
+        if (prefetcher && !bfs::exists(filename))
+        {
+            if (FileBufferPtr buffer = prefetcher->get(filename))
+                return buffer;
+        }
+
+        return readAllDirect(filename);
+    }
+
+    void prefetch(const std::vector<std::string>& paths, int32_t priority)
+    {
+        if (!prefetcher)
+            return;
+
+        std::vector<std::string> mpqPaths;
+        for (const auto& path : paths)
+        {
+            if (!bfs::exists(path))
+                mpqPaths.push_back(path);
+        }
+
+        prefetcher->prefetch(mpqPaths, priority);
+    }
+
+    PrefetchStats getPrefetchStats()
+    {
+        if (prefetcher)
+            return prefetcher->stats();
+
+        return PrefetchStats();
+    }
+
+    FileBufferPtr readAllDirect(const std::string& filename)
+    {
+        bfs::path path(filename);
+        path.make_preferred();
+
+        if (bfs::exists(filename))
+        {
+            boost::system::error_code error;
+            size_t size = static_cast<size_t>(bfs::file_size(filename, error));
+
+            // Mapping an empty file is an error, so let the generic path below deal with it
+            if (!error && size > 0)
+            {
+                if (FileBufferPtr buffer = FileBuffer::fromFile(filename))
+                    return buffer;
+            }
+        }
+        else if (mappedDiabdat.isOpen())
+        {
+            FileBufferPtr buffer = readMappedMpqFile(getStormLibPath(path));
+            if (!buffer)
+                std::cerr << "File " << path << " not found" << std::endl;
+
+            return buffer;
+        }
+
+        FAFile* file = FAfopen(filename);
+        if (!file)
+            return nullptr;
+
+        std::shared_ptr<std::vector<uint8_t>> contents = std::make_shared<std::vector<uint8_t>>(FAsize(file));
+        size_t bytesRead = FAfread(contents->data(), 1, contents->size(), file);
+        FAfclose(file);
+
+        contents->resize(bytesRead);
+
+        return std::make_shared<FileBuffer>(contents, contents->data(), contents->size());
+    }
+
     uint32_t read32(FAFile* file)
     {
         uint32_t tmp;
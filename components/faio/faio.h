@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -13,7 +14,10 @@
 
 namespace FAIO
 {
-    // A FILE* like container for either a normal FILE*, or a StormLib HANDLE
+    class MpqFile;
+    struct MemoryFile;
+
+    // A FILE* like container for either a normal FILE*, a file in our own memory mapped MPQ reader, an in memory buffer, or a StormLib HANDLE
     struct FAFile
     {
     private:
@@ -25,12 +29,16 @@ namespace FAIO
                 std::string* filename;
             } plainFile;
             void* mpqFile; // This is a pointer to a StormLib HANDLE type, I jist didn't want to #include StormLib here
+            MpqFile* mappedMpqFile;
+            MemoryFile* memoryFile;
         } data;
 
         enum FAFileMode
         {
             PlainFile,
-            MPQFile
+            MPQFile,
+            MappedMPQFile,
+            MemoryFile
         } mode;
 
         FAFile();
@@ -43,9 +51,51 @@ namespace FAIO
         friend size_t FAsize(FAFile* stream);
     };
 
+    /// An immutable, contiguous buffer holding the whole decompressed contents of a file.
+    /// Plain files are memory mapped, files in the MPQ are decompressed once into memory,
+    /// or point straight into the mapped archive if they are stored uncompressed.
+    class FileBuffer
+    {
+    public:
+        FileBuffer(std::shared_ptr<const void> owner, const uint8_t* data, size_t size);
+
+        /// Memory maps a plain file, returns nullptr if that fails
+        static std::shared_ptr<const FileBuffer> fromFile(const std::string& path);
+
+        const uint8_t* data() const { return mData; }
+        size_t size() const { return mSize; }
+
+        // These return 0 if the read would go past the end of the buffer
+        uint32_t read32(size_t offset) const;
+        uint16_t read16(size_t offset) const;
+        uint8_t read8(size_t offset) const;
+
+    private:
+        std::shared_ptr<const void> mOwner; ///< keeps whatever mData points into alive
+        const uint8_t* mData;
+        size_t mSize;
+    };
+
+    typedef std::shared_ptr<const FileBuffer> FileBufferPtr;
+
+    struct PrefetchStats
+    {
+        uint64_t hits;      ///< readAll found the file already prefetched
+        uint64_t lateHits;  ///< readAll had to wait for a prefetch that was still in progress
+        uint64_t misses;    ///< readAll of an MPQ file that wasn't prefetched
+        uint64_t loads;     ///< files loaded by the prefetch workers
+        uint64_t evictions; ///< prefetched files dropped to stay under the memory limit
+        size_t cachedBytes;
+        size_t queued;
+    };
+
     bool init(const std::string pathMPQ = "DIABDAT.MPQ", const std::string listFile = "");
     std::vector<std::string> listMpqFiles(const std::string& pattern);
 
+    /// Keeps decompressed copies of MPQ files in directory, and uses them instead of the MPQ from then on.
+    /// Must be called after init, maxBytes is the size limit for the whole cache.
+    bool initDiskCache(const std::string& directory, uint64_t maxBytes);
+
     void quit();
 
     bool exists(const std::string& filename);
@@ -56,6 +106,20 @@ namespace FAIO
     size_t FAftell(FAFile* stream);
     size_t FAsize(FAFile* stream);
 
+    /// Reads the whole file in one go, returns nullptr if it doesn't exist.
+    /// Prefer this over lots of small FAfread calls when you are going to parse the whole file anyway.
+    FileBufferPtr readAll(const std::string& filename);
+
+    // Some standard prefetch priorities, anything in between works too
+    const int32_t PREFETCH_PRIORITY_BACKGROUND = 0;
+    const int32_t PREFETCH_PRIORITY_SOON = 50;
+    const int32_t PREFETCH_PRIORITY_IMMEDIATE = 100;
+
+    /// Queues files from the MPQ to be decompressed in the background, so a later readAll of them is just a cache hit.
+    /// Requests with a higher priority are served first. Paths that exist on disk are ignored, as there is nothing to gain.
+    void prefetch(const std::vector<std::string>& paths, int32_t priority = 0);
+    PrefetchStats getPrefetchStats();
+
     uint32_t read32(FAFile* file);
     uint16_t read16(FAFile* file);
     uint8_t read8(FAFile* file);
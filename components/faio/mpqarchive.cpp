@@ -0,0 +1,462 @@
+#include "mpqarchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <misc/md5.h>
+
+// We don't want warnings from StormLibs headers
+#include <misc/disablewarn.h>
+#include <StormLib.h>
+#include <misc/enablewarn.h>
+
+namespace bip = boost::interprocess;
+
+namespace FAIO
+{
+    namespace
+    {
+        const uint32_t MPQ_HEADER_MAGIC = 0x1A51504D; // "MPQ\x1A"
+        const uint32_t MPQ_HEADER_SIZE_V1 = 0x20;
+
+        const uint32_t HASH_ENTRY_EMPTY = 0xFFFFFFFF;
+        const uint32_t HASH_ENTRY_DELETED = 0xFFFFFFFE;
+
+        const uint32_t MPQ_FILE_IMPLODE = 0x00000100;
+        const uint32_t MPQ_FILE_COMPRESS = 0x00000200;
+        const uint32_t MPQ_FILE_ENCRYPTED = 0x00010000;
+        const uint32_t MPQ_FILE_FIX_KEY = 0x00020000;
+        const uint32_t MPQ_FILE_SINGLE_UNIT = 0x01000000;
+        const uint32_t MPQ_FILE_SECTOR_CRC = 0x04000000;
+        const uint32_t MPQ_FILE_EXISTS = 0x80000000;
+
+        enum HashType
+        {
+            HashTableOffset = 0,
+            HashNameA = 1,
+            HashNameB = 2,
+            HashFileKey = 3
+        };
+
+#pragma pack(push, 1)
+        struct MpqHeader
+        {
+            uint32_t magic;
+            uint32_t headerSize;
+            uint32_t archiveSize;
+            uint16_t formatVersion;
+            uint16_t sectorSizeShift;
+            uint32_t hashTablePos;
+            uint32_t blockTablePos;
+            uint32_t hashTableSize;
+            uint32_t blockTableSize;
+        };
+#pragma pack(pop)
+
+        struct CryptTable
+        {
+            uint32_t values[0x500];
+
+            CryptTable()
+            {
+                uint32_t seed = 0x00100001;
+
+                for (uint32_t index1 = 0; index1 < 0x100; index1++)
+                {
+                    for (uint32_t index2 = index1, i = 0; i < 5; i++, index2 += 0x100)
+                    {
+                        seed = (seed * 125 + 3) % 0x2AAAAB;
+                        uint32_t temp1 = (seed & 0xFFFF) << 0x10;
+
+                        seed = (seed * 125 + 3) % 0x2AAAAB;
+                        uint32_t temp2 = (seed & 0xFFFF);
+
+                        values[index2] = temp1 | temp2;
+                    }
+                }
+            }
+        };
+
+        // function local static so initialisation is thread safe
+        const uint32_t* cryptTable()
+        {
+            static const CryptTable table;
+            return table.values;
+        }
+
+        // Same normalisation as StormLib: case insensitive, and / is treated as a path separator
+        uint32_t hashString(const std::string& str, HashType type)
+        {
+            const uint32_t* table = cryptTable();
+
+            uint32_t seed1 = 0x7FED7FED;
+            uint32_t seed2 = 0xEEEEEEEE;
+
+            for (size_t i = 0; i < str.size(); i++)
+            {
+                uint32_t ch = (uint8_t)str[i];
+
+                if (ch == '/')
+                    ch = '\\';
+                else if (ch >= 'a' && ch <= 'z')
+                    ch -= 'a' - 'A';
+
+                seed1 = table[(type << 8) + ch] ^ (seed1 + seed2);
+                seed2 = ch + seed1 + seed2 + (seed2 << 5) + 3;
+            }
+
+            return seed1;
+        }
+
+        void decryptBlock(uint32_t* data, size_t bytes, uint32_t key)
+        {
+            const uint32_t* table = cryptTable();
+            uint32_t seed = 0xEEEEEEEE;
+
+            for (size_t i = 0; i < bytes / 4; i++)
+            {
+                seed += table[0x400 + (key & 0xFF)];
+                uint32_t ch = data[i] ^ (key + seed);
+
+                key = ((~key << 0x15) + 0x11111111) | (key >> 0x0B);
+                seed = ch + seed + (seed << 5) + 3;
+                data[i] = ch;
+            }
+        }
+
+        uint32_t fileKey(const std::string& filename, const MpqArchive::BlockEntry& block)
+        {
+            size_t separator = filename.find_last_of("\\/");
+            std::string name = separator == std::string::npos ? filename : filename.substr(separator + 1);
+
+            uint32_t key = hashString(name, HashFileKey);
+
+            if (block.flags & MPQ_FILE_FIX_KEY)
+                key = (key + block.offset) ^ block.fileSize;
+
+            return key;
+        }
+    }
+
+    MpqArchive::MpqArchive() {}
+
+    MpqArchive::~MpqArchive() {}
+
+    bool MpqArchive::open(const std::string& path)
+    {
+        close();
+
+        try
+        {
+            bip::file_mapping mapping(path.c_str(), bip::read_only);
+            mRegion = std::make_shared<bip::mapped_region>(mapping, bip::read_only);
+        }
+        catch (const bip::interprocess_exception& e)
+        {
+            std::cerr << "Failed to map " << path << ": " << e.what() << std::endl;
+            mRegion.reset();
+            return false;
+        }
+
+        const uint8_t* region = static_cast<const uint8_t*>(mRegion->get_address());
+        size_t regionSize = mRegion->get_size();
+
+        // The archive doesn't have to start at the beginning of the file, but it must be 512 byte aligned
+        MpqHeader header;
+        size_t headerPos = 0;
+        for (; headerPos + sizeof(MpqHeader) <= regionSize; headerPos += 0x200)
+        {
+            memcpy(&header, region + headerPos, sizeof(MpqHeader));
+            if (header.magic == MPQ_HEADER_MAGIC && header.headerSize >= MPQ_HEADER_SIZE_V1)
+                break;
+        }
+
+        if (headerPos + sizeof(MpqHeader) > regionSize)
+        {
+            std::cerr << path << " is not an MPQ archive" << std::endl;
+            close();
+            return false;
+        }
+
+        const uint8_t* archive = region + headerPos;
+        size_t archiveSize = regionSize - headerPos;
+
+        if (header.hashTableSize == 0 || (header.hashTableSize & (header.hashTableSize - 1)) != 0 ||
+            header.hashTablePos + uint64_t(header.hashTableSize) * sizeof(HashEntry) > archiveSize ||
+            header.blockTablePos + uint64_t(header.blockTableSize) * sizeof(BlockEntry) > archiveSize)
+        {
+            std::cerr << "Unsupported or corrupt MPQ tables in " << path << std::endl;
+            close();
+            return false;
+        }
+
+        Misc::md5_state_t md5State;
+        Misc::md5_byte_t digest[16];
+
+        Misc::md5_init(&md5State);
+        Misc::md5_append(&md5State, archive, sizeof(MpqHeader));
+        Misc::md5_append(&md5State, archive + header.hashTablePos, header.hashTableSize * sizeof(HashEntry));
+        Misc::md5_append(&md5State, archive + header.blockTablePos, header.blockTableSize * sizeof(BlockEntry));
+        Misc::md5_finish(&md5State, digest);
+
+        std::stringstream fingerprint;
+        for (size_t i = 0; i < 16; i++)
+            fingerprint << std::hex << std::setw(2) << std::setfill('0') << (int)digest[i];
+
+        mFingerprint = fingerprint.str();
+
+        mHashTable.resize(header.hashTableSize);
+        memcpy(mHashTable.data(), archive + header.hashTablePos, header.hashTableSize * sizeof(HashEntry));
+        decryptBlock(reinterpret_cast<uint32_t*>(mHashTable.data()), mHashTable.size() * sizeof(HashEntry), hashString("(hash table)", HashFileKey));
+
+        mBlockTable.resize(header.blockTableSize);
+        if (!mBlockTable.empty())
+        {
+            memcpy(mBlockTable.data(), archive + header.blockTablePos, header.blockTableSize * sizeof(BlockEntry));
+            decryptBlock(
+                reinterpret_cast<uint32_t*>(mBlockTable.data()), mBlockTable.size() * sizeof(BlockEntry), hashString("(block table)", HashFileKey));
+        }
+
+        mData = archive;
+        mSize = archiveSize;
+        mSectorSize = 0x200 << header.sectorSizeShift;
+
+        return true;
+    }
+
+    void MpqArchive::close()
+    {
+        mData = nullptr;
+        mSize = 0;
+        mFingerprint.clear();
+        mHashTable.clear();
+        mBlockTable.clear();
+        mRegion.reset();
+    }
+
+    const MpqArchive::BlockEntry* MpqArchive::find(const std::string& filename) const
+    {
+        if (!isOpen())
+            return nullptr;
+
+        uint32_t mask = mHashTable.size() - 1;
+        uint32_t start = hashString(filename, HashTableOffset) & mask;
+        uint32_t nameA = hashString(filename, HashNameA);
+        uint32_t nameB = hashString(filename, HashNameB);
+
+        for (uint32_t i = start;;)
+        {
+            const HashEntry& entry = mHashTable[i];
+
+            if (entry.blockIndex == HASH_ENTRY_EMPTY)
+                break;
+
+            if (entry.blockIndex != HASH_ENTRY_DELETED && entry.name1 == nameA && entry.name2 == nameB && entry.blockIndex < mBlockTable.size())
+            {
+                const BlockEntry& block = mBlockTable[entry.blockIndex];
+
+                if ((block.flags & MPQ_FILE_EXISTS) && block.offset + uint64_t(block.compressedSize) <= mSize)
+                    return &block;
+            }
+
+            i = (i + 1) & mask;
+            if (i == start)
+                break;
+        }
+
+        return nullptr;
+    }
+
+    MpqFile::MpqFile(const MpqArchive& archive, const MpqArchive::BlockEntry& block, const std::string& filename) : mArchive(archive), mBlock(block)
+    {
+        if (mBlock.flags & MPQ_FILE_ENCRYPTED)
+            mKey = fileKey(filename, mBlock);
+
+        mSectorSize = (mBlock.flags & MPQ_FILE_SINGLE_UNIT) ? mBlock.fileSize : mArchive.sectorSize();
+    }
+
+    bool MpqFile::open()
+    {
+        bool compressed = (mBlock.flags & (MPQ_FILE_IMPLODE | MPQ_FILE_COMPRESS)) != 0;
+
+        if (!compressed || (mBlock.flags & MPQ_FILE_SINGLE_UNIT) || mBlock.fileSize == 0)
+            return true;
+
+        uint32_t sectorCount = (mBlock.fileSize + mSectorSize - 1) / mSectorSize;
+        uint32_t entries = sectorCount + 1 + ((mBlock.flags & MPQ_FILE_SECTOR_CRC) ? 1 : 0);
+
+        if (uint64_t(entries) * 4 > mBlock.compressedSize)
+            return false;
+
+        mSectorOffsets.resize(entries);
+        memcpy(mSectorOffsets.data(), mArchive.data() + mBlock.offset, entries * 4);
+
+        if (mBlock.flags & MPQ_FILE_ENCRYPTED)
+            decryptBlock(mSectorOffsets.data(), entries * 4, mKey - 1);
+
+        for (uint32_t i = 0; i < sectorCount; i++)
+        {
+            if (mSectorOffsets[i] > mSectorOffsets[i + 1] || mSectorOffsets[i + 1] > mBlock.compressedSize)
+                return false;
+        }
+
+        return true;
+    }
+
+    const uint8_t* MpqFile::storedData() const
+    {
+        if ((mBlock.flags & (MPQ_FILE_IMPLODE | MPQ_FILE_COMPRESS | MPQ_FILE_ENCRYPTED)) != 0 || mBlock.compressedSize < mBlock.fileSize)
+            return nullptr;
+
+        return mArchive.data() + mBlock.offset;
+    }
+
+    uint32_t MpqFile::sectorLength(uint32_t sector) const { return std::min(mSectorSize, mBlock.fileSize - sector * mSectorSize); }
+
+    bool MpqFile::decodeSector(uint32_t sector, uint8_t* out)
+    {
+        uint32_t outLength = sectorLength(sector);
+        const uint8_t* src = mArchive.data() + mBlock.offset;
+        uint32_t srcLength;
+
+        bool compressed = (mBlock.flags & (MPQ_FILE_IMPLODE | MPQ_FILE_COMPRESS)) != 0;
+
+        if (mBlock.flags & MPQ_FILE_SINGLE_UNIT)
+        {
+            srcLength = mBlock.compressedSize;
+        }
+        else if (compressed)
+        {
+            src += mSectorOffsets[sector];
+            srcLength = mSectorOffsets[sector + 1] - mSectorOffsets[sector];
+        }
+        else
+        {
+            src += sector * mSectorSize;
+            srcLength = std::min(outLength, mBlock.compressedSize - sector * mSectorSize);
+        }
+
+        if (mBlock.flags & MPQ_FILE_ENCRYPTED)
+        {
+            mScratch.assign(src, src + srcLength);
+            decryptBlock(reinterpret_cast<uint32_t*>(mScratch.data()), srcLength, mKey + sector);
+            src = mScratch.data();
+        }
+
+        if (compressed && srcLength < outLength)
+        {
+            int decompressedLength = outLength;
+            int success;
+
+            // Neither of these write to their input, so passing the read only mapping is fine
+            if (mBlock.flags & MPQ_FILE_IMPLODE)
+                success = SCompExplode(out, &decompressedLength, const_cast<uint8_t*>(src), srcLength);
+            else
+                success = SCompDecompress(out, &decompressedLength, const_cast<uint8_t*>(src), srcLength);
+
+            return success && uint32_t(decompressedLength) == outLength;
+        }
+
+        if (srcLength < outLength)
+            return false;
+
+        memcpy(out, src, outLength);
+        return true;
+    }
+
+    size_t MpqFile::read(void* ptr, size_t bytes)
+    {
+        uint8_t* dest = static_cast<uint8_t*>(ptr);
+
+        if (mPos >= mBlock.fileSize)
+            return 0;
+
+        bytes = std::min(bytes, mBlock.fileSize - mPos);
+
+        // Plain stored files can be copied straight out of the mapping
+        if ((mBlock.flags & (MPQ_FILE_IMPLODE | MPQ_FILE_COMPRESS | MPQ_FILE_ENCRYPTED)) == 0)
+        {
+            if (mBlock.offset + uint64_t(mPos + bytes) > mArchive.size())
+                return 0;
+
+            memcpy(dest, mArchive.data() + mBlock.offset + mPos, bytes);
+            mPos += bytes;
+            return bytes;
+        }
+
+        size_t done = 0;
+        while (done < bytes)
+        {
+            uint32_t sector = mPos / mSectorSize;
+            uint32_t inSector = mPos % mSectorSize;
+            uint32_t length = sectorLength(sector);
+            size_t count = std::min<size_t>(length - inSector, bytes - done);
+
+            if (sector == mCachedSector)
+            {
+                memcpy(dest + done, mSectorCache.data() + inSector, count);
+            }
+            else if (inSector == 0 && count == length)
+            {
+                // Whole sector requested, decode straight into the callers buffer
+                if (!decodeSector(sector, dest + done))
+                    break;
+            }
+            else
+            {
+                mSectorCache.resize(mSectorSize);
+                if (!decodeSector(sector, mSectorCache.data()))
+                {
+                    mCachedSector = -1;
+                    break;
+                }
+
+                mCachedSector = sector;
+                memcpy(dest + done, mSectorCache.data() + inSector, count);
+            }
+
+            done += count;
+            mPos += count;
+        }
+
+        if (done < bytes)
+            std::cerr << "Error reading from MPQ file, data is corrupt or uses an unsupported compression" << std::endl;
+
+        return done;
+    }
+
+    int MpqFile::seek(int64_t offset, int origin)
+    {
+        int64_t base;
+
+        switch (origin)
+        {
+            case SEEK_SET:
+                base = 0;
+                break;
+
+            case SEEK_CUR:
+                base = mPos;
+                break;
+
+            case SEEK_END:
+                base = mBlock.fileSize;
+                break;
+
+            default:
+                return 1; // error, incorrect origin
+        }
+
+        if (base + offset < 0)
+            return 1;
+
+        mPos = base + offset;
+        return 0;
+    }
+}
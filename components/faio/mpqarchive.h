@@ -0,0 +1,115 @@
+#ifndef FAIO_MPQARCHIVE_H
+#define FAIO_MPQARCHIVE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace boost
+{
+    namespace interprocess
+    {
+        class mapped_region;
+    }
+}
+
+namespace FAIO
+{
+    /// A read only view of an MPQ archive, independent of StormLib.
+    /// The archive is memory mapped once and its hash and block tables are decrypted up front,
+    /// after which it is never modified again. That means any number of threads can look files
+    /// up and read them at the same time without any locking, all per read state lives in MpqFile.
+    class MpqArchive
+    {
+    public:
+        struct BlockEntry
+        {
+            uint32_t offset;         ///< relative to the start of the archive
+            uint32_t compressedSize; ///< size of the file as stored in the archive
+            uint32_t fileSize;       ///< decompressed size
+            uint32_t flags;
+        };
+
+        MpqArchive();
+        ~MpqArchive();
+
+        bool open(const std::string& path);
+        void close();
+        bool isOpen() const { return mData != nullptr; }
+
+        /// @return the block entry for the file, or nullptr if it is not in the archive
+        const BlockEntry* find(const std::string& filename) const;
+
+        const uint8_t* data() const { return mData; }
+        std::shared_ptr<const void> mapping() const { return mRegion; }
+        size_t size() const { return mSize; }
+        uint32_t sectorSize() const { return mSectorSize; }
+
+        /// MD5 of the header and the raw hash and block tables, which identifies the archive
+        /// contents without having to hash the whole file
+        const std::string& fingerprint() const { return mFingerprint; }
+
+    private:
+        struct HashEntry
+        {
+            uint32_t name1;
+            uint32_t name2;
+            uint16_t locale;
+            uint16_t platform;
+            uint32_t blockIndex;
+        };
+
+        MpqArchive(const MpqArchive&) = delete;
+        MpqArchive& operator=(const MpqArchive&) = delete;
+
+        std::shared_ptr<boost::interprocess::mapped_region> mRegion;
+        const uint8_t* mData = nullptr; ///< start of the archive inside the mapped region
+        size_t mSize = 0;
+        uint32_t mSectorSize = 0;
+        std::string mFingerprint;
+
+        std::vector<HashEntry> mHashTable;
+        std::vector<BlockEntry> mBlockTable;
+    };
+
+    /// One open file inside an MpqArchive.
+    /// Each instance owns its own decompressed sector cache, so it must not be shared between threads
+    /// without external synchronisation, but separate instances never contend with each other.
+    class MpqFile
+    {
+    public:
+        MpqFile(const MpqArchive& archive, const MpqArchive::BlockEntry& block, const std::string& filename);
+
+        /// Loads the sector offset table, must succeed before the file can be read.
+        bool open();
+
+        size_t read(void* ptr, size_t bytes);
+        int seek(int64_t offset, int origin);
+        size_t tell() const { return mPos; }
+        size_t size() const { return mBlock.fileSize; }
+
+        /// @return the file contents inside the mapped archive if it is stored without compression or encryption, otherwise nullptr
+        const uint8_t* storedData() const;
+
+    private:
+        uint32_t sectorLength(uint32_t sector) const;
+        bool decodeSector(uint32_t sector, uint8_t* out);
+
+        const MpqArchive& mArchive;
+        MpqArchive::BlockEntry mBlock;
+        uint32_t mKey = 0;
+        uint32_t mSectorSize = 0;
+
+        std::vector<uint32_t> mSectorOffsets; ///< only used for compressed, multi sector files
+        std::vector<uint8_t> mSectorCache;
+        int64_t mCachedSector = -1;
+        std::vector<uint8_t> mScratch; ///< decryption buffer, as the mapped archive is read only
+
+        size_t mPos = 0;
+    };
+}
+
+#endif
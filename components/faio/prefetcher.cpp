@@ -0,0 +1,208 @@
+#include "prefetcher.h"
+
+#include <iostream>
+
+namespace FAIO
+{
+    Prefetcher::Prefetcher(Loader loader, size_t workerCount, size_t maxBytes)
+        : mLoader(loader), mMaxBytes(maxBytes), mHits(0), mLateHits(0), mMisses(0), mLoads(0), mEvictions(0)
+    {
+        for (size_t i = 0; i < workerCount; i++)
+            mWorkers.push_back(std::thread(&Prefetcher::workerLoop, this));
+    }
+
+    Prefetcher::~Prefetcher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+
+        mWorkAvailable.notify_all();
+
+        for (auto& worker : mWorkers)
+            worker.join();
+    }
+
+    std::string Prefetcher::normalise(const std::string& path)
+    {
+        std::string retval = path;
+
+        for (size_t i = 0; i < retval.size(); i++)
+        {
+            if (retval[i] == '\\')
+                retval[i] = '/';
+            else if (retval[i] >= 'A' && retval[i] <= 'Z')
+                retval[i] += 'a' - 'A';
+        }
+
+        return retval;
+    }
+
+    void Prefetcher::prefetch(const std::vector<std::string>& paths, int32_t priority)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            for (const auto& path : paths)
+            {
+                std::string key = normalise(path);
+
+                auto it = mEntries.find(key);
+                if (it != mEntries.end())
+                {
+                    // Already have it, just make sure it doesn't get evicted before it's used
+                    if (it->second.buffer)
+                        mLruList.splice(mLruList.begin(), mLruList, it->second.lruIt);
+
+                    continue;
+                }
+
+                // If it's already queued with a lower priority, the new request just overtakes it,
+                // the worker that picks up the old one will find it isn't queued any more and skip it
+                mQueued.insert(key);
+                mQueue.push(Request{priority, mNextSequence++, key, path});
+            }
+        }
+
+        mWorkAvailable.notify_all();
+    }
+
+    FileBufferPtr Prefetcher::get(const std::string& path)
+    {
+        std::string key = normalise(path);
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        auto it = mEntries.find(key);
+
+        if (it == mEntries.end())
+        {
+            mMisses++;
+
+            if (!mQueued.erase(key))
+                return nullptr;
+
+            // Requested, but no worker got to it yet. Load it right here rather than making the caller
+            // do it, so it still ends up in the cache for whoever else asked for it.
+            mEntries[key].buffer = nullptr;
+
+            lock.unlock();
+            FileBufferPtr buffer = mLoader(path);
+            lock.lock();
+
+            finishLoad(key, buffer);
+            lock.unlock();
+
+            mLoaded.notify_all();
+            return buffer;
+        }
+
+        if (!it->second.buffer)
+        {
+            mLoaded.wait(lock, [&]() {
+                it = mEntries.find(key);
+                return it == mEntries.end() || it->second.buffer;
+            });
+
+            // The load failed, let the caller try (and report the error) itself
+            if (it == mEntries.end())
+            {
+                mMisses++;
+                return nullptr;
+            }
+
+            mLateHits++;
+        }
+        else
+        {
+            mHits++;
+        }
+
+        mLruList.splice(mLruList.begin(), mLruList, it->second.lruIt);
+        return it->second.buffer;
+    }
+
+    PrefetchStats Prefetcher::stats() const
+    {
+        PrefetchStats stats;
+        stats.hits = mHits;
+        stats.lateHits = mLateHits;
+        stats.misses = mMisses;
+        stats.loads = mLoads;
+        stats.evictions = mEvictions;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        stats.cachedBytes = mCachedBytes;
+        stats.queued = mQueued.size();
+
+        return stats;
+    }
+
+    void Prefetcher::workerLoop()
+    {
+        while (true)
+        {
+            Request request;
+
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWorkAvailable.wait(lock, [&]() { return mStop || !mQueue.empty(); });
+
+                if (mStop)
+                    return;
+
+                request = mQueue.top();
+                mQueue.pop();
+
+                // Either a duplicate of a request that was already handled, or someone else loaded it in the meantime
+                if (!mQueued.erase(request.key) || mEntries.count(request.key))
+                    continue;
+
+                mEntries[request.key].buffer = nullptr;
+            }
+
+            FileBufferPtr buffer = mLoader(request.path);
+            mLoads++;
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                finishLoad(request.key, buffer);
+            }
+
+            mLoaded.notify_all();
+        }
+    }
+
+    void Prefetcher::finishLoad(const std::string& key, FileBufferPtr buffer)
+    {
+        if (!buffer)
+        {
+            mEntries.erase(key);
+            return;
+        }
+
+        Entry& entry = mEntries[key];
+        entry.buffer = buffer;
+
+        mLruList.push_front(key);
+        entry.lruIt = mLruList.begin();
+
+        mCachedBytes += buffer->size();
+        evict();
+    }
+
+    void Prefetcher::evict()
+    {
+        // Never evict the most recently used entry, otherwise a file bigger than the whole cache would be loaded for nothing
+        while (mCachedBytes > mMaxBytes && mLruList.size() > 1)
+        {
+            auto it = mEntries.find(mLruList.back());
+
+            mCachedBytes -= it->second.buffer->size();
+            mEntries.erase(it);
+            mLruList.pop_back();
+
+            mEvictions++;
+        }
+    }
+}
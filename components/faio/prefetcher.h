@@ -0,0 +1,89 @@
+#ifndef FAIO_PREFETCHER_H
+#define FAIO_PREFETCHER_H
+
+#include "faio.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace FAIO
+{
+    /// Pool of worker threads that load files ahead of time into a bounded in memory cache.
+    /// Requests with a higher priority are started first, requests with equal priority in the order they were made.
+    class Prefetcher
+    {
+    public:
+        typedef std::function<FileBufferPtr(const std::string&)> Loader;
+
+        Prefetcher(Loader loader, size_t workerCount, size_t maxBytes);
+        ~Prefetcher();
+
+        void prefetch(const std::vector<std::string>& paths, int32_t priority);
+
+        /// @return the prefetched file, or nullptr if it wasn't prefetched.
+        /// If a worker is loading it right now, this waits for it to finish instead of loading it a second time.
+        FileBufferPtr get(const std::string& path);
+
+        PrefetchStats stats() const;
+
+    private:
+        struct Request
+        {
+            int32_t priority;
+            uint64_t sequence;
+            std::string key;
+            std::string path;
+
+            bool operator<(const Request& other) const
+            {
+                if (priority != other.priority)
+                    return priority < other.priority;
+                return sequence > other.sequence;
+            }
+        };
+
+        struct Entry
+        {
+            FileBufferPtr buffer; ///< nullptr while loading
+            std::list<std::string>::iterator lruIt;
+        };
+
+        static std::string normalise(const std::string& path);
+        void workerLoop();
+        void finishLoad(const std::string& key, FileBufferPtr buffer); ///< must be called with mMutex held
+        void evict();
+
+        Loader mLoader;
+        size_t mMaxBytes;
+
+        mutable std::mutex mMutex;
+        std::condition_variable mWorkAvailable;
+        std::condition_variable mLoaded;
+        bool mStop = false;
+
+        std::priority_queue<Request> mQueue;
+        std::unordered_set<std::string> mQueued;
+        uint64_t mNextSequence = 0;
+
+        std::unordered_map<std::string, Entry> mEntries;
+        std::list<std::string> mLruList; ///< most recently used at the front, only holds entries that finished loading
+        size_t mCachedBytes = 0;
+
+        std::atomic<uint64_t> mHits;
+        std::atomic<uint64_t> mLateHits;
+        std::atomic<uint64_t> mMisses;
+        std::atomic<uint64_t> mLoads;
+        std::atomic<uint64_t> mEvictions;
+
+        std::vector<std::thread> mWorkers;
+    };
+}
+
+#endif
@@ -18,6 +18,7 @@ namespace Level
         : mTilesetCelPath(tileSetPath), mTilPath(tilPath), mMinPath(minPath), mSolPath(solPath), mDun(dun), mTil(mTilPath), mMin(mMinPath), mSol(mSolPath),
           mDoorMap(doorMap), mUpStairs(upStairs), mDownStairs(downStairs), mPrevious(previous), mNext(next)
     {
+        buildTileGrids();
     }
 
     Level::Level(Serial::Loader& loader)
@@ -43,6 +44,8 @@ namespace Level
 
         mPrevious = loader.load<int32_t>();
         mNext = loader.load<int32_t>();
+
+        buildTileGrids();
     }
 
     void Level::save(Serial::Saver& saver)
@@ -135,6 +138,38 @@ namespace Level
 
     Misc::Helper2D<const Level, const MinPillar> Level::operator[](int32_t x) const { return Misc::Helper2D<const Level, const MinPillar>(*this, x, get); }
 
+    void Level::buildTileGrids()
+    {
+        mGridWidth = width();
+        mGridHeight = height();
+        mPillarIndices.resize(size_t(mGridWidth) * mGridHeight);
+        mPassable.resize(size_t(mGridWidth) * mGridHeight);
+
+        for (int32_t y = 0; y < mGridHeight; y++)
+        {
+            for (int32_t x = 0; x < mGridWidth; x++)
+            {
+                const MinPillar pillar = get(x, y, *this);
+                mPillarIndices[x + y * mGridWidth] = pillar.index();
+                mPassable[x + y * mGridWidth] = pillar.passable();
+            }
+        }
+    }
+
+    void Level::updateTileGrids(int32_t xDunIndex, int32_t yDunIndex)
+    {
+        // each dun entry covers a 2x2 block of tiles
+        for (int32_t y = yDunIndex * 2; y < yDunIndex * 2 + 2; y++)
+        {
+            for (int32_t x = xDunIndex * 2; x < xDunIndex * 2 + 2; x++)
+            {
+                const MinPillar pillar = get(x, y, *this);
+                mPillarIndices[x + y * mGridWidth] = pillar.index();
+                mPassable[x + y * mGridWidth] = pillar.passable();
+            }
+        }
+    }
+
     void Level::activate(int32_t x, int32_t y)
     {
         int32_t xDunIndex = x;
@@ -151,7 +186,10 @@ namespace Level
 
         // open doors when clicked on
         if (mDoorMap.find(index) != mDoorMap.end())
+        {
             mDun[xDunIndex][yDunIndex] = mDoorMap[index];
+            updateTileGrids(xDunIndex, yDunIndex);
+        }
     }
 
     int32_t Level::minSize() const { return mMin.size(); }
@@ -61,6 +61,15 @@ namespace Level
 
         Misc::Helper2D<const Level, const MinPillar> operator[](int32_t x) const;
 
+        /// Same as (*this)[x][y].index(), -1 for tiles with no pillar, but read from a grid that is built when the level is
+        /// created or loaded and kept up to date by activate(), instead of looking through the dun, til and min every time
+        int32_t pillarIndex(int32_t x, int32_t y) const { return mPillarIndices[x + y * mGridWidth]; }
+        /// Same as (*this)[x][y].passable(), from a grid kept the same way as pillarIndex(). False outside the level
+        bool isPassable(int32_t x, int32_t y) const
+        {
+            return x >= 0 && x < mGridWidth && y >= 0 && y < mGridHeight && mPassable[x + y * mGridWidth];
+        }
+
         void activate(int32_t x, int32_t y);
 
         int32_t minSize() const;
@@ -82,6 +91,11 @@ namespace Level
         int32_t getPreviousLevel() const { return mPrevious; }
 
     private:
+        /// Fills mPillarIndices and mPassable for the whole level, called by both constructors
+        void buildTileGrids();
+        /// Refills the 2x2 block of tiles under one dun entry, after activate() swaps a door in or out
+        void updateTileGrids(int32_t xDunIndex, int32_t yDunIndex);
+
         std::string mTilesetCelPath; ///< path to cel file for level
         std::string mTilPath;        ///< path to til file for level
         std::string mMinPath;        ///< path to min file for level
@@ -102,6 +116,12 @@ namespace Level
 
         int32_t mPrevious; ///< index of previous level
         int32_t mNext;     ///< index of next level
+
+        // per tile, row by row, so the things asked about every tile every frame or tick don't have to go through get()
+        std::vector<int32_t> mPillarIndices; ///< pillarIndex() of every tile
+        std::vector<uint8_t> mPassable;      ///< isPassable() of every tile
+        int32_t mGridWidth = 0;
+        int32_t mGridHeight = 0;
     };
 }
 
@@ -1,16 +1,19 @@
 #include "min.h"
 
+#include <cstring>
 #include <iostream>
 #include <stdio.h>
 
-#include <faio/fafileobject.h>
+#include <faio/faio.h>
 #include <misc/stringops.h>
 
 namespace Level
 {
     Min::Min(const std::string& filename)
     {
-        FAIO::FAFileObject minF(filename);
+        FAIO::FileBufferPtr minF = FAIO::readAll(filename);
+        if (!minF)
+            return;
 
         size_t minSize;
         // These two files contain 16 blocks, all else are 10. Nothing to do but a workaround...
@@ -19,17 +22,11 @@ namespace Level
         else
             minSize = 10;
 
-        size_t numPillars = minF.FAsize() / (minSize * 2);
-
-        minF.FAfseek(0, SEEK_SET);
-
-        std::vector<int16_t> temp(minSize);
+        size_t numPillars = minF->size() / (minSize * 2);
+        mPillars.resize(numPillars, std::vector<int16_t>(minSize));
 
         for (size_t i = 0; i < numPillars; i++)
-        {
-            minF.FAfread(&temp[0], 2, minSize);
-            mPillars.push_back(std::vector<int16_t>(temp));
-        }
+            memcpy(mPillars[i].data(), minF->data() + i * minSize * 2, minSize * 2);
     }
 
     const std::vector<int16_t>& Min::operator[](size_t index) const { return mPillars[index]; }
@@ -1,16 +1,14 @@
 #include "sol.h"
 
-#include <faio/fafileobject.h>
+#include <faio/faio.h>
 
 namespace Level
 {
     Sol::Sol(const std::string& path)
     {
-        FAIO::FAFileObject solF(path);
-        size_t size = solF.FAsize();
-        mData.resize(size);
-
-        solF.FAfread(&mData[0], 1, size);
+        FAIO::FileBufferPtr solF = FAIO::readAll(path);
+        if (solF)
+            mData.assign(solF->data(), solF->data() + solF->size());
     }
 
     bool Sol::passable(size_t index) const
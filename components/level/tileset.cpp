@@ -1,26 +1,23 @@
 #include "tileset.h"
 
+#include <cstring>
 #include <stdio.h>
 
-#include <faio/fafileobject.h>
+#include <faio/faio.h>
 
 namespace Level
 {
     TileSet::TileSet(const std::string& filename)
     {
-        FAIO::FAFileObject tFile(filename);
+        FAIO::FileBufferPtr tFile = FAIO::readAll(filename);
+        if (!tFile)
+            return;
 
-        size_t numBlocks = tFile.FAsize() / (4 * 2);
-
-        tFile.FAfseek(0, SEEK_SET);
-
-        TilBlock tmp(4);
+        size_t numBlocks = tFile->size() / (4 * 2);
+        mBlocks.resize(numBlocks, TilBlock(4));
 
         for (size_t i = 0; i < numBlocks; i++)
-        {
-            tFile.FAfread(&tmp[0], 2, 4);
-            mBlocks.push_back(tmp);
-        }
+            memcpy(mBlocks[i].data(), tFile->data() + i * 4 * 2, 4 * 2);
     }
 
     const TilBlock& TileSet::operator[](size_t index) const { return mBlocks[index]; }
@@ -0,0 +1,31 @@
+#include "allocationcounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace Misc
+{
+    namespace AllocationCounter
+    {
+        static std::atomic<uint64_t> allocations{0};
+        static std::atomic<uint64_t> bytes{0};
+
+        uint64_t count() { return allocations.load(std::memory_order_relaxed); }
+
+        uint64_t totalBytes() { return bytes.load(std::memory_order_relaxed); }
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    Misc::AllocationCounter::allocations.fetch_add(1, std::memory_order_relaxed);
+    Misc::AllocationCounter::bytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
@@ -0,0 +1,22 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+namespace Misc
+{
+    ///
+    /// Counts every allocation the program makes, for benchmark tools that report allocations alongside times.
+    /// The counting is done by replacement global operator new and delete in allocationcounter.cpp. Replacing those is program
+    /// wide, so that file is built as its own object library, AllocationCounter, which only the benchmark tools are built with.
+    ///
+    namespace AllocationCounter
+    {
+        /// Calls to operator new so far
+        uint64_t count();
+        /// Bytes asked for by those calls, including anything since freed
+        uint64_t totalBytes();
+    }
+}
+
+#endif
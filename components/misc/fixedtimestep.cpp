@@ -0,0 +1,47 @@
+#include "fixedtimestep.h"
+
+#include <misc/assert.h>
+#include <thread>
+
+namespace Misc
+{
+    FixedTimestep::FixedTimestep(uint32_t stepsPerSecond, uint32_t maxCatchUpSteps)
+        : mStepsPerSecond(stepsPerSecond), mMaxCatchUpSteps(maxCatchUpSteps), mStart(Clock::now())
+    {
+        release_assert(stepsPerSecond > 0 && maxCatchUpSteps > 0);
+    }
+
+    uint32_t FixedTimestep::stepsDue(Clock::time_point now)
+    {
+        if (now < nextStepTime())
+            return 0;
+
+        // the last step with stepTime(step) <= now, rounded the same way stepTime() rounds
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - mStart).count();
+        uint64_t lastDue = ((elapsed + 1) * mStepsPerSecond - 1) / 1000000000;
+
+        uint64_t due = lastDue + 1 - mStepsScheduled;
+        mStepsScheduled += due;
+
+        if (due > mMaxCatchUpSteps)
+        {
+            mSkippedSteps += due - mMaxCatchUpSteps;
+            due = mMaxCatchUpSteps;
+        }
+
+        return uint32_t(due);
+    }
+
+    void FixedTimestep::waitForNextStep() const { std::this_thread::sleep_until(nextStepTime()); }
+
+    FixedTimestep::Clock::duration FixedTimestep::stepLength() const
+    {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(1000000000 / mStepsPerSecond));
+    }
+
+    FixedTimestep::Clock::time_point FixedTimestep::stepTime(uint64_t step) const
+    {
+        // multiply before dividing so rounding errors don't add up over time
+        return mStart + std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(step * 1000000000 / mStepsPerSecond));
+    }
+}
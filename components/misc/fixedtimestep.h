@@ -0,0 +1,46 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+#include <chrono>
+#include <cstdint>
+
+namespace Misc
+{
+    ///
+    /// Schedules steps that have to happen a fixed number of times per second, like game ticks or capped frames.
+    /// Every step's deadline is worked out from the time the schedule started, never from when the last step happened
+    /// to finish, so the rate doesn't drift however late individual steps run.
+    /// When the caller falls behind it gets several steps at once to catch up, up to maxCatchUpSteps; anything past
+    /// that is skipped, so one long stall can't cause a spiral of catching up.
+    ///
+    class FixedTimestep
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        FixedTimestep(uint32_t stepsPerSecond, uint32_t maxCatchUpSteps);
+
+        /// How many steps should be run now, these are considered done once returned
+        uint32_t stepsDue() { return stepsDue(Clock::now()); }
+        uint32_t stepsDue(Clock::time_point now);
+
+        void waitForNextStep() const;
+
+        Clock::time_point nextStepTime() const { return stepTime(mStepsScheduled); }
+        Clock::time_point lastStepTime() const { return stepTime(mStepsScheduled ? mStepsScheduled - 1 : 0); } ///< when the most recent step was due
+        Clock::duration stepLength() const;
+
+        uint64_t skippedSteps() const { return mSkippedSteps; }
+
+    private:
+        Clock::time_point stepTime(uint64_t step) const;
+
+        uint32_t mStepsPerSecond;
+        uint32_t mMaxCatchUpSteps;
+        Clock::time_point mStart;
+        uint64_t mStepsScheduled = 0; ///< run or skipped
+        uint64_t mSkippedSteps = 0;
+    };
+}
+
+#endif
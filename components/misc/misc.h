@@ -26,6 +26,16 @@ namespace Misc
         Point operator/(int c) const { return {x / c, y / c}; }
     };
 
+    // Rectangle on a tile grid, inclusive at both ends
+    struct TileRect
+    {
+        int32_t minX;
+        int32_t minY;
+        int32_t maxX;
+        int32_t maxY;
+        bool contains(int32_t x, int32_t y) const { return x >= minX && x <= maxX && y >= minY && y <= maxY; }
+    };
+
     namespace detail
     {
         template <typename RetType, typename... Args> class overload_class;
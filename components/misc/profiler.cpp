@@ -0,0 +1,145 @@
+#include "profiler.h"
+
+#ifdef FA_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Misc
+{
+    namespace Profiler
+    {
+        struct Event
+        {
+            const char* name;
+            int64_t startNs;
+            int64_t endNs;
+        };
+
+        struct ThreadBuffer
+        {
+            uint32_t id;
+            std::string name;
+
+            // Only the owning thread writes, but writeChromeTrace can read from another thread at any time.
+            // The lock is never contended outside of that, so it costs very little.
+            std::mutex mutex;
+            std::vector<Event> events; ///< ring buffer, EVENTS_PER_THREAD long
+            size_t next = 0;
+            size_t count = 0;
+        };
+
+        static std::atomic<bool> enabled{false};
+        static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+        // Buffers are kept after their thread exits, so its events still make it into the trace
+        static std::mutex buffersMutex;
+        static std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+        static ThreadBuffer& threadBuffer()
+        {
+            thread_local std::shared_ptr<ThreadBuffer> buffer;
+            if (!buffer)
+            {
+                buffer = std::make_shared<ThreadBuffer>();
+                buffer->events.resize(EVENTS_PER_THREAD);
+
+                std::lock_guard<std::mutex> lock(buffersMutex);
+                buffer->id = uint32_t(buffers.size());
+                buffers.push_back(buffer);
+            }
+
+            return *buffer;
+        }
+
+        void setEnabled(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+
+        bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+        void setThreadName(const std::string& name)
+        {
+            ThreadBuffer& buffer = threadBuffer();
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            buffer.name = name;
+        }
+
+        int64_t nowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count(); }
+
+        void record(const char* name, int64_t startNs, int64_t endNs)
+        {
+            ThreadBuffer& buffer = threadBuffer();
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+
+            buffer.events[buffer.next] = Event{name, startNs, endNs};
+            buffer.next = (buffer.next + 1) % EVENTS_PER_THREAD;
+            if (buffer.count < EVENTS_PER_THREAD)
+                buffer.count++;
+        }
+
+        static void writeJsonString(std::ostream& out, const std::string& str)
+        {
+            out << '"';
+            for (char c : str)
+            {
+                if (c == '"' || c == '\\')
+                    out << '\\';
+                out << c;
+            }
+            out << '"';
+        }
+
+        bool writeChromeTrace(const std::string& path)
+        {
+            std::ofstream out(path);
+            if (!out)
+                return false;
+
+            std::vector<std::shared_ptr<ThreadBuffer>> allBuffers;
+            {
+                std::lock_guard<std::mutex> lock(buffersMutex);
+                allBuffers = buffers;
+            }
+
+            // Complete ("X") events, timestamps and durations in microseconds
+            out << std::fixed << std::setprecision(3);
+            out << "{\"traceEvents\":[\n";
+            bool first = true;
+            for (const auto& buffer : allBuffers)
+            {
+                std::lock_guard<std::mutex> lock(buffer->mutex);
+
+                if (!buffer->name.empty())
+                {
+                    out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":" << buffer->id << ",\"args\":{\"name\":";
+                    writeJsonString(out, buffer->name);
+                    out << "}}";
+                    first = false;
+                }
+
+                size_t oldest = (buffer->next + EVENTS_PER_THREAD - buffer->count) % EVENTS_PER_THREAD;
+                for (size_t i = 0; i < buffer->count; i++)
+                {
+                    const Event& event = buffer->events[(oldest + i) % EVENTS_PER_THREAD];
+
+                    out << (first ? "" : ",\n") << "{\"ph\":\"X\",\"name\":";
+                    writeJsonString(out, event.name);
+                    out << ",\"pid\":0,\"tid\":" << buffer->id << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << (event.endNs - event.startNs) / 1000.0
+                        << "}";
+                    first = false;
+                }
+
+                buffer->count = 0;
+            }
+            out << "\n]}\n";
+
+            return bool(out);
+        }
+    }
+}
+
+#endif
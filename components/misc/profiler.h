@@ -0,0 +1,73 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+///
+/// A minimal profiler, for seeing where the time in a tick or a frame goes.
+/// Put FA_PROFILE_ZONE("name") at the top of a scope, and the time spent in the rest of the scope is recorded while
+/// profiling is switched on. Each thread records into its own fixed size ring buffer, so only the most recent zones
+/// are kept. writeChromeTrace() dumps what's been recorded in the trace event format, which chrome://tracing and
+/// https://ui.perfetto.dev can open.
+///
+/// Only built when FA_PROFILER is defined (cmake -DFA_PROFILER=ON), otherwise the zones compile to nothing.
+///
+
+#ifdef FA_PROFILER
+
+#define FA_PROFILE_CONCAT_IMPL(a, b) a##b
+#define FA_PROFILE_CONCAT(a, b) FA_PROFILE_CONCAT_IMPL(a, b)
+/// name has to be a string literal, only the pointer is stored
+#define FA_PROFILE_ZONE(name) Misc::Profiler::Zone FA_PROFILE_CONCAT(faProfileZone, __LINE__)(name)
+
+namespace Misc
+{
+    namespace Profiler
+    {
+        constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+
+        void setEnabled(bool enabled);
+        bool isEnabled();
+
+        /// Shows up in the trace instead of a number, call from the thread itself
+        void setThreadName(const std::string& name);
+
+        /// Writes everything still in the ring buffers of all threads, and clears them
+        /// @return false if the file couldn't be written
+        bool writeChromeTrace(const std::string& path);
+
+        int64_t nowNs();
+        void record(const char* name, int64_t startNs, int64_t endNs);
+
+        class Zone
+        {
+        public:
+            explicit Zone(const char* name) : mName(name), mStart(isEnabled() ? nowNs() : -1) {}
+            ~Zone()
+            {
+                if (mStart != -1)
+                    record(mName, mStart, nowNs());
+            }
+
+            Zone(const Zone&) = delete;
+            Zone& operator=(const Zone&) = delete;
+
+        private:
+            const char* mName;
+            int64_t mStart; ///< -1 if profiling was off when the zone started
+        };
+    }
+}
+
+#else
+
+#define FA_PROFILE_ZONE(name)                                                                                                                                  \
+    do                                                                                                                                                         \
+    {                                                                                                                                                          \
+    } while (0)
+
+#endif
+
+#endif
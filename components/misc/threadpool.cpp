@@ -0,0 +1,132 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace Misc
+{
+    struct ThreadPool::Job
+    {
+        const std::function<void(size_t)>* func;
+        size_t count;
+        std::atomic<size_t> next;
+        std::atomic<size_t> finished;
+
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    ThreadPool::ThreadPool(size_t workerCount)
+    {
+        for (size_t i = 0; i < workerCount; i++)
+            mWorkers.push_back(std::thread(&ThreadPool::workerLoop, this));
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+
+        mWorkAvailable.notify_all();
+
+        for (auto& worker : mWorkers)
+            worker.join();
+    }
+
+    ThreadPool& ThreadPool::get()
+    {
+        static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    void ThreadPool::runJob(Job& job)
+    {
+        size_t ranHere = 0;
+
+        for (size_t i = job.next++; i < job.count; i = job.next++)
+        {
+            (*job.func)(i);
+            ranHere++;
+        }
+
+        if (ranHere && (job.finished += ranHere) == job.count)
+        {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.done.notify_all();
+        }
+    }
+
+    void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& func)
+    {
+        if (count == 0)
+            return;
+
+        if (count == 1 || mWorkers.empty())
+        {
+            for (size_t i = 0; i < count; i++)
+                func(i);
+            return;
+        }
+
+        auto job = std::make_shared<Job>();
+        job->func = &func;
+        job->count = count;
+        job->next = 0;
+        job->finished = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mJobs.push_back(job);
+        }
+
+        mWorkAvailable.notify_all();
+
+        // The calling thread works too, so this still finishes if every worker is busy with something else
+        runJob(*job);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            for (auto it = mJobs.begin(); it != mJobs.end(); ++it)
+            {
+                if (*it == job)
+                {
+                    mJobs.erase(it);
+                    break;
+                }
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->done.wait(lock, [&] { return job->finished == job->count; });
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        while (true)
+        {
+            std::shared_ptr<Job> job;
+
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWorkAvailable.wait(lock, [&] { return mStop || !mJobs.empty(); });
+
+                if (mStop)
+                    return;
+
+                job = mJobs.front();
+
+                // Once every index has been handed out there's nothing left for anyone else to pick up
+                if (job->next >= job->count)
+                {
+                    mJobs.pop_front();
+                    continue;
+                }
+            }
+
+            runJob(*job);
+        }
+    }
+}
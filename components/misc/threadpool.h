@@ -0,0 +1,45 @@
+#ifndef FA_THREADPOOL_H
+#define FA_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Misc
+{
+    /// Fixed set of worker threads for splitting CPU heavy work, like decoding sprites, into independent pieces.
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(size_t workerCount);
+        ~ThreadPool();
+
+        /// Pool shared by everything in the process, with one worker per core apart from the calling thread
+        static ThreadPool& get();
+
+        /// Runs func(0) to func(count - 1) spread across the workers and the calling thread, and returns when they have all finished.
+        /// It's fine to call this from several threads at once, or from inside func.
+        void parallelFor(size_t count, const std::function<void(size_t)>& func);
+
+        size_t workerCount() const { return mWorkers.size(); }
+
+    private:
+        struct Job;
+
+        static void runJob(Job& job);
+        void workerLoop();
+
+        std::mutex mMutex;
+        std::condition_variable mWorkAvailable;
+        std::deque<std::shared_ptr<Job>> mJobs;
+        bool mStop = false;
+
+        std::vector<std::thread> mWorkers;
+    };
+}
+
+#endif
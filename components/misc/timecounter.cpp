@@ -0,0 +1,6 @@
+#include "timecounter.h"
+
+namespace Misc
+{
+    std::atomic<bool> TimeCounter::mEnabled{false};
+}
@@ -0,0 +1,71 @@
+#ifndef TIME_COUNTER_H
+#define TIME_COUNTER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Misc
+{
+    ///
+    /// Adds up how many times, and for how long in total, a piece of code runs.
+    /// Unlike profiler zones these are always built in, so tools like the headless benchmark can report totals from a
+    /// normal build. The clock is only read while counting is switched on with setEnabled(), otherwise a Scope costs a branch.
+    /// A counter isn't thread safe, each one should only be used from one thread.
+    ///
+    class TimeCounter
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        static void setEnabled(bool enabled) { mEnabled.store(enabled, std::memory_order_relaxed); }
+        static bool isEnabled() { return mEnabled.load(std::memory_order_relaxed); }
+
+        void add(Clock::duration duration)
+        {
+            mTotal += duration;
+            mCalls++;
+        }
+
+        void reset()
+        {
+            mTotal = Clock::duration::zero();
+            mCalls = 0;
+        }
+
+        Clock::duration total() const { return mTotal; }
+        uint64_t calls() const { return mCalls; }
+
+        /// Counts the time until the end of the enclosing scope. Don't nest scopes for the same counter, they'd be counted twice
+        class Scope
+        {
+        public:
+            explicit Scope(TimeCounter& counter) : mCounter(isEnabled() ? &counter : nullptr)
+            {
+                if (mCounter)
+                    mStart = Clock::now();
+            }
+
+            ~Scope()
+            {
+                if (mCounter)
+                    mCounter->add(Clock::now() - mStart);
+            }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            TimeCounter* mCounter; ///< nullptr if counting was off when the scope started
+            Clock::time_point mStart;
+        };
+
+    private:
+        static std::atomic<bool> mEnabled;
+
+        Clock::duration mTotal = Clock::duration::zero();
+        uint64_t mCalls = 0;
+    };
+}
+
+#endif
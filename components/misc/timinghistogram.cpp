@@ -0,0 +1,51 @@
+#include "timinghistogram.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace Misc
+{
+    static int64_t bucketUpperBound(size_t bucket) { return int64_t(1) << bucket; }
+
+    void TimingHistogram::record(std::chrono::steady_clock::duration duration)
+    {
+        int64_t us = std::max(int64_t(0), int64_t(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+
+        size_t bucket = 0;
+        while (bucket < BUCKET_COUNT - 1 && us >= bucketUpperBound(bucket))
+            bucket++;
+
+        mBuckets[bucket]++;
+        mCount++;
+        mMaxMicroseconds = std::max(mMaxMicroseconds, us);
+    }
+
+    void TimingHistogram::clear()
+    {
+        mBuckets.fill(0);
+        mCount = 0;
+        mMaxMicroseconds = 0;
+    }
+
+    std::chrono::microseconds TimingHistogram::percentile(double fraction) const
+    {
+        uint64_t target = uint64_t(fraction * mCount + 0.5);
+        uint64_t seen = 0;
+
+        for (size_t bucket = 0; bucket < BUCKET_COUNT - 1; bucket++)
+        {
+            seen += mBuckets[bucket];
+            if (seen >= target)
+                return std::chrono::microseconds(std::min(bucketUpperBound(bucket), mMaxMicroseconds));
+        }
+
+        return max();
+    }
+
+    std::string TimingHistogram::summary() const
+    {
+        std::ostringstream ss;
+        ss << "p50 <= " << percentile(0.5).count() << "us, p99 <= " << percentile(0.99).count() << "us, max " << max().count() << "us";
+        return ss.str();
+    }
+}
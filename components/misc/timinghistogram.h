@@ -0,0 +1,38 @@
+#ifndef TIMING_HISTOGRAM_H
+#define TIMING_HISTOGRAM_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace Misc
+{
+    ///
+    /// Counts durations in power of two buckets of microseconds: 0-1us, 1-2us, 2-4us...
+    /// Fixed size and cheap to record into, so it can sit in a loop that runs every frame.
+    ///
+    class TimingHistogram
+    {
+    public:
+        static constexpr size_t BUCKET_COUNT = 25; ///< the last bucket takes everything over 8 seconds
+
+        void record(std::chrono::steady_clock::duration duration);
+        void clear();
+
+        uint64_t count() const { return mCount; }
+        /// Upper bound of the bucket the given fraction (0 to 1) of the recorded durations fall under
+        std::chrono::microseconds percentile(double fraction) const;
+        std::chrono::microseconds max() const { return std::chrono::microseconds(mMaxMicroseconds); }
+
+        /// One line, like "p50 <= 8192us, p99 <= 16384us, max 17012us"
+        std::string summary() const;
+
+    private:
+        std::array<uint64_t, BUCKET_COUNT> mBuckets = {};
+        uint64_t mCount = 0;
+        int64_t mMaxMicroseconds = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Misc
+{
+    ///
+    /// Lock free handoff of snapshots from one producer thread to one consumer thread.
+    /// There are three slots: the producer fills its back slot and publishes it, which swaps it with the middle slot, and
+    /// the consumer swaps the middle slot with its front slot whenever it wants the latest snapshot. Neither side ever
+    /// waits or copies anything, and each only touches the slot it owns, so the slots' storage (vectors etc) can be
+    /// reused forever without allocating once they've grown to the size they need.
+    ///
+    /// The producer always gets a slot to write to. If it publishes twice before the consumer looks, the older snapshot
+    /// is never seen, and counted as dropped. If the consumer looks twice without anything new having been published,
+    /// it gets the same snapshot again, and that is counted as stale.
+    ///
+    template <class T> class TripleBuffer
+    {
+    public:
+        TripleBuffer() = default;
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        /// Producer only. The slot to fill, stays the same until publish() is called.
+        T& back() { return mSlots[mBack]; }
+
+        /// Producer only. Hands the back slot over to the consumer.
+        void publish()
+        {
+            uint32_t previous = mMiddle.exchange(mBack | NEW_BIT, std::memory_order_acq_rel);
+            if (previous & NEW_BIT)
+                mDropped.fetch_add(1, std::memory_order_relaxed);
+
+            mBack = previous & INDEX_MASK;
+        }
+
+        /// Consumer only. The most recently published snapshot, which stays untouched until the next call.
+        /// @return nullptr if nothing has been published yet
+        T* latest()
+        {
+            if (mMiddle.load(std::memory_order_relaxed) & NEW_BIT)
+            {
+                mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) & INDEX_MASK;
+                mHasFront = true;
+            }
+            else if (mHasFront)
+            {
+                mStale.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            return mHasFront ? &mSlots[mFront] : nullptr;
+        }
+
+        uint64_t droppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+        uint64_t staleCount() const { return mStale.load(std::memory_order_relaxed); }
+
+        /// For setting up and tearing down the slots, only safe while neither thread is using the buffer
+        template <class Func> void forEachSlot(Func func)
+        {
+            for (auto& slot : mSlots)
+                func(slot);
+        }
+
+    private:
+        static constexpr uint32_t NEW_BIT = 4; ///< set in mMiddle when it was published and hasn't been picked up yet
+        static constexpr uint32_t INDEX_MASK = 3;
+
+        std::array<T, 3> mSlots;
+
+        uint32_t mBack = 0;  ///< only touched by the producer
+        uint32_t mFront = 1; ///< only touched by the consumer
+        bool mHasFront = false;
+        std::atomic<uint32_t> mMiddle{2};
+
+        std::atomic<uint64_t> mDropped{0};
+        std::atomic<uint64_t> mStale{0};
+    };
+}
+
+#endif
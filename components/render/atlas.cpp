@@ -0,0 +1,156 @@
+#include "atlas.h"
+
+#include <string.h>
+
+#include "sdl_gl_funcs.h"
+#include <misc/assert.h>
+
+namespace Render
+{
+    bool ShelfPacker::allocate(int32_t width, int32_t height, int32_t& x, int32_t& y)
+    {
+        if (width > mWidth || height > mHeight)
+            return false;
+
+        // tightest existing shelf that still has room
+        Shelf* best = nullptr;
+        for (auto& shelf : mShelves)
+        {
+            if (shelf.height >= height && mWidth - shelf.used >= width && (!best || shelf.height < best->height))
+                best = &shelf;
+        }
+
+        bool canOpenShelf = mNextShelfY + height <= mHeight;
+
+        // Putting a short rectangle on a much taller shelf wastes the space above it, so prefer a new shelf then
+        if (!best || (canOpenShelf && best->height > height + height / 2))
+        {
+            if (!canOpenShelf)
+                return false;
+
+            mShelves.push_back(Shelf{mNextShelfY, height, 0});
+            mNextShelfY += height;
+            best = &mShelves.back();
+        }
+
+        x = best->used;
+        y = best->y;
+        best->used += width;
+
+        return true;
+    }
+
+    void ShelfPacker::clear()
+    {
+        mShelves.clear();
+        mNextShelfY = 0;
+    }
+
+    constexpr int32_t TextureAtlas::PAGE_SIZE;
+    constexpr int32_t TextureAtlas::MAX_PACKED_SIZE;
+    constexpr int32_t TextureAtlas::PADDING;
+
+    static GLuint createTexture(int32_t width, int32_t height, const void* pixels)
+    {
+        GLuint tex = 0;
+
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        return tex;
+    }
+
+    AtlasRegion TextureAtlas::add(int32_t width, int32_t height, const void* pixels)
+    {
+        debug_assert(width > 0 && height > 0);
+
+        AtlasRegion region;
+        region.width = width;
+        region.height = height;
+
+        if (width > MAX_PACKED_SIZE || height > MAX_PACKED_SIZE)
+        {
+            region.texture = createTexture(width, height, pixels);
+            return region;
+        }
+
+        int32_t paddedWidth = width + 2 * PADDING;
+        int32_t paddedHeight = height + 2 * PADDING;
+
+        int32_t x = 0, y = 0;
+        size_t pageIndex = 0;
+        for (; pageIndex < mPages.size(); pageIndex++)
+        {
+            if (mPages[pageIndex].packer.allocate(paddedWidth, paddedHeight, x, y))
+                break;
+        }
+
+        if (pageIndex == mPages.size())
+        {
+            mPages.emplace_back(createTexture(PAGE_SIZE, PAGE_SIZE, nullptr));
+            bool fits = mPages.back().packer.allocate(paddedWidth, paddedHeight, x, y);
+            release_assert(fits);
+        }
+
+        Page& page = mPages[pageIndex];
+        page.liveRegions++;
+
+        // Upload the border along with the frame, the page itself starts out uninitialised
+        mUploadBuffer.assign(size_t(paddedWidth) * paddedHeight * 4, 0);
+        for (int32_t row = 0; row < height; row++)
+        {
+            const uint8_t* src = static_cast<const uint8_t*>(pixels) + size_t(row) * width * 4;
+            uint8_t* dest = &mUploadBuffer[(size_t(row + PADDING) * paddedWidth + PADDING) * 4];
+            memcpy(dest, src, size_t(width) * 4);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, page.texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, paddedWidth, paddedHeight, GL_RGBA, GL_UNSIGNED_BYTE, mUploadBuffer.data());
+
+        region.texture = page.texture;
+        region.page = int32_t(pageIndex);
+        region.u = float(x + PADDING) / PAGE_SIZE;
+        region.v = float(y + PADDING) / PAGE_SIZE;
+        region.uSize = float(width) / PAGE_SIZE;
+        region.vSize = float(height) / PAGE_SIZE;
+
+        return region;
+    }
+
+    void TextureAtlas::release(const AtlasRegion& region)
+    {
+        if (region.page == -1)
+        {
+            GLuint tex = region.texture;
+            glDeleteTextures(1, &tex);
+            return;
+        }
+
+        // the atlas has already been destroyed
+        if (size_t(region.page) >= mPages.size())
+            return;
+
+        Page& page = mPages[region.page];
+
+        debug_assert(page.liveRegions > 0);
+        page.liveRegions--;
+
+        if (page.liveRegions == 0)
+            page.packer.clear();
+    }
+
+    void TextureAtlas::destroy()
+    {
+        for (auto& page : mPages)
+        {
+            GLuint tex = page.texture;
+            glDeleteTextures(1, &tex);
+        }
+
+        mPages.clear();
+    }
+}
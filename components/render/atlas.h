@@ -0,0 +1,91 @@
+#ifndef RENDER_ATLAS_H
+#define RENDER_ATLAS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace Render
+{
+    ///
+    /// Where one sprite frame lives on the GPU: a rectangle of pixels inside a (usually shared) texture.
+    ///
+    struct AtlasRegion
+    {
+        uint32_t texture = 0; ///< GL texture name
+        int32_t page = -1;    ///< index of the atlas page, or -1 if the region has a texture all to itself
+        int32_t width = 0;    ///< size of the sprite in pixels
+        int32_t height = 0;
+        float u = 0.0f; ///< top left corner of the sprite in texture coordinates
+        float v = 0.0f;
+        float uSize = 1.0f; ///< size of the sprite in texture coordinates
+        float vSize = 1.0f;
+    };
+
+    ///
+    /// Hands out rectangles from a fixed size area by stacking horizontal shelves on top of each other.
+    /// Each rectangle goes on the lowest shelf it fits on, and a new shelf is opened when none has room.
+    /// Individual rectangles can't be given back, only the whole area at once with clear().
+    ///
+    class ShelfPacker
+    {
+    public:
+        ShelfPacker(int32_t width, int32_t height) : mWidth(width), mHeight(height) {}
+
+        /// @return false if there is no room left for a width x height rectangle
+        bool allocate(int32_t width, int32_t height, int32_t& x, int32_t& y);
+        void clear();
+
+    private:
+        struct Shelf
+        {
+            int32_t y;
+            int32_t height;
+            int32_t used; ///< width already handed out, from the left edge
+        };
+
+        int32_t mWidth;
+        int32_t mHeight;
+        int32_t mNextShelfY = 0;
+        std::vector<Shelf> mShelves;
+    };
+
+    ///
+    /// Packs sprite frames into a handful of large RGBA textures ("pages"), so that drawing a level doesn't need
+    /// a texture bind per pillar. Frames too big to share a page nicely get a texture of their own.
+    /// The space on a page is reused once every region on it has been released.
+    /// All of this has to happen on the thread that owns the GL context.
+    ///
+    class TextureAtlas
+    {
+    public:
+        static constexpr int32_t PAGE_SIZE = 2048;
+        static constexpr int32_t MAX_PACKED_SIZE = PAGE_SIZE / 4; ///< frames larger than this in either dimension get their own texture
+        static constexpr int32_t PADDING = 1; ///< transparent border kept around every packed frame, so filtering and outline sampling don't pick up neighbours
+
+        /// Uploads width x height pixels, rows tightly packed top to bottom, bytes in r, g, b, a order
+        AtlasRegion add(int32_t width, int32_t height, const void* pixels);
+        void release(const AtlasRegion& region);
+
+        /// Deletes every page texture, for shutting down the GL context
+        void destroy();
+
+        size_t pageCount() const { return mPages.size(); }
+
+    private:
+        struct Page
+        {
+            Page(uint32_t textureArg) : texture(textureArg), packer(PAGE_SIZE, PAGE_SIZE) {}
+
+            uint32_t texture;
+            ShelfPacker packer;
+            size_t liveRegions = 0;
+        };
+
+        std::vector<Page> mPages;
+        std::vector<uint8_t> mUploadBuffer;
+    };
+}
+
+#endif
@@ -0,0 +1,91 @@
+#include "blit.h"
+
+#include <algorithm>
+#include <cel/pal.h>
+#include <cstring>
+
+namespace Render
+{
+    namespace
+    {
+        uint8_t* pixelAt(const ImageView& image, int32_t x, int32_t y) { return image.pixels + y * image.pitch + x * 4; }
+
+        /// Shrinks a width x height rectangle at (x, y) to fit inside image, moving (srcX, srcY) along with its top left corner.
+        /// @return false if nothing is left
+        bool clip(const ImageView& image, int32_t& x, int32_t& y, int32_t& srcX, int32_t& srcY, int32_t& width, int32_t& height)
+        {
+            if (x < 0)
+            {
+                srcX -= x;
+                width += x;
+                x = 0;
+            }
+
+            if (y < 0)
+            {
+                srcY -= y;
+                height += y;
+                y = 0;
+            }
+
+            width = std::min(width, image.width - x);
+            height = std::min(height, image.height - y);
+
+            return width > 0 && height > 0;
+        }
+    }
+
+    void blitColoursMasked(const ImageView& dest, int32_t x, int32_t y, const Cel::Colour* src, int32_t srcWidth, int32_t srcHeight)
+    {
+        int32_t srcX = 0;
+        int32_t srcY = 0;
+        int32_t width = srcWidth;
+        int32_t height = srcHeight;
+
+        if (!clip(dest, x, y, srcX, srcY, width, height))
+            return;
+
+        for (int32_t row = 0; row < height; row++)
+        {
+            const Cel::Colour* in = src + (srcY + row) * srcWidth + srcX;
+            uint8_t* out = pixelAt(dest, x, y + row);
+
+            for (int32_t i = 0; i < width; i++, out += 4)
+            {
+                if (!in[i].visible)
+                    continue;
+
+                out[0] = in[i].r;
+                out[1] = in[i].g;
+                out[2] = in[i].b;
+                out[3] = 255;
+            }
+        }
+    }
+
+    void blitCopy(const ImageView& dest, int32_t destX, int32_t destY, const ImageView& src, int32_t srcX, int32_t srcY, int32_t width, int32_t height)
+    {
+        // Clip against the source by treating it as the destination of the reverse copy
+        if (!clip(src, srcX, srcY, destX, destY, width, height) || !clip(dest, destX, destY, srcX, srcY, width, height))
+            return;
+
+        for (int32_t row = 0; row < height; row++)
+            memcpy(pixelAt(dest, destX, destY + row), pixelAt(src, srcX, srcY + row), width * 4);
+    }
+
+    void applyColourKey(const ImageView& image, uint8_t r, uint8_t g, uint8_t b)
+    {
+        for (int32_t y = 0; y < image.height; y++)
+        {
+            uint8_t* p = pixelAt(image, 0, y);
+
+            for (int32_t x = 0; x < image.width; x++, p += 4)
+            {
+                if (p[0] == r && p[1] == g && p[2] == b)
+                    memset(p, 0, 4);
+                else if (p[3] != 255)
+                    p[3] = 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef RENDER_BLIT_H
+#define RENDER_BLIT_H
+
+#include <stdint.h>
+
+namespace Cel
+{
+    struct Colour;
+}
+
+namespace Render
+{
+    ///
+    /// 32 bit image in memory with the bytes of each pixel in r, g, b, a order.
+    /// This is the layout of the surfaces from createTransparentSurface, and of GL_RGBA textures.
+    ///
+    struct ImageView
+    {
+        uint8_t* pixels;
+        int32_t width;
+        int32_t height;
+        int32_t pitch; ///< bytes from the start of one row to the start of the next
+    };
+
+    // All of these work a row at a time and clip against the edges of the images involved.
+
+    /// Draws srcWidth x srcHeight colours, rows top to bottom, at (x, y) in dest. Invisible colours are skipped, visible ones are fully opaque.
+    void blitColoursMasked(const ImageView& dest, int32_t x, int32_t y, const Cel::Colour* src, int32_t srcWidth, int32_t srcHeight);
+
+    /// Copies a width x height rectangle, alpha included, from (srcX, srcY) in src to (destX, destY) in dest.
+    void blitCopy(const ImageView& dest, int32_t destX, int32_t destY, const ImageView& src, int32_t srcX, int32_t srcY, int32_t width, int32_t height);
+
+    /// Clears every pixel of the key colour to fully transparent black, and makes every other pixel either fully opaque or,
+    /// if it wasn't opaque already, fully transparent.
+    void applyColourKey(const ImageView& image, uint8_t r, uint8_t g, uint8_t b);
+}
+
+#endif
@@ -1,19 +1,42 @@
 #include "levelobjects.h"
 
+#include <misc/assert.h>
+
 namespace Render
 {
     void LevelObjects::resize(int32_t x, int32_t y)
     {
+        clear();
         mData.resize(x * y);
         mWidth = x;
         mHeight = y;
     }
 
-    std::vector<LevelObject>& get(int32_t x, int32_t y, LevelObjects& objs) { return objs.mData[x + y * objs.mWidth]; }
+    void LevelObjects::add(int32_t x, int32_t y, const LevelObject& object, boost::optional<Cel::Colour> hoverColor)
+    {
+        debug_assert(x >= 0 && x < mWidth && y >= 0 && y < mHeight);
+
+        int32_t index = x + y * mWidth;
+        if (mData[index].empty())
+            mOccupied.push_back(index);
+
+        mData[index].push_back(object);
+        mData[index].back().hoverColorIndex = -1;
 
-    Misc::Helper2D<LevelObjects, std::vector<LevelObject>&> LevelObjects::operator[](int32_t x)
+        if (hoverColor)
+        {
+            mData[index].back().hoverColorIndex = int32_t(mHoverColors.size());
+            mHoverColors.push_back(*hoverColor);
+        }
+    }
+
+    void LevelObjects::clear()
     {
-        return Misc::Helper2D<LevelObjects, std::vector<LevelObject>&>(*this, x, get);
+        for (int32_t index : mOccupied)
+            mData[index].clear();
+
+        mOccupied.clear();
+        mHoverColors.clear();
     }
 
     int32_t LevelObjects::width() { return mWidth; }
@@ -4,12 +4,7 @@
 #include "render.h"
 
 #include <boost/optional.hpp>
-#include <misc/helper2d.h>
-
-namespace Cel
-{
-    struct Colour;
-}
+#include <cel/pal.h>
 
 namespace Render
 {
@@ -17,31 +12,49 @@ namespace Render
 
     struct LevelObject
     {
-        bool valid;
         int32_t spriteCacheIndex;
         int32_t spriteFrame;
         int32_t x2;
         int32_t y2;
         int32_t dist;
-        boost::optional<Cel::Colour> hoverColor;
+        int32_t distPerTick; ///< added to dist by the next tick, for drawing in between ticks
+        int32_t hoverColorIndex; ///< into LevelObjects' hover colours, -1 if the object isn't highlighted. Use LevelObjects::hoverColor().
     };
 
+    ///
+    /// The objects standing on each tile of a level, rebuilt by the renderer every frame.
+    /// Only a handful of tiles are ever occupied, so the grid remembers which ones it put something on,
+    /// and clear() only has to visit those instead of the whole level. Cleared tiles keep their capacity, so once warmed up
+    /// a rebuild doesn't allocate. Hover colours are rare, so they're stored off to the side rather than in every object.
+    ///
     class LevelObjects
     {
     public:
+        /// Also empties every tile
         void resize(int32_t x, int32_t y);
 
-        Misc::Helper2D<LevelObjects, std::vector<LevelObject>&> operator[](int32_t x);
+        void clear();
+        void add(int32_t x, int32_t y, const LevelObject& object, boost::optional<Cel::Colour> hoverColor = boost::none);
+
+        /// The objects on tile (x, y), in the order they were added. Inline, as drawLevel calls this for every tile on screen.
+        const std::vector<LevelObject>& objects(int32_t x, int32_t y) const { return mData[x + y * mWidth]; }
+
+        boost::optional<Cel::Colour> hoverColor(const LevelObject& object) const
+        {
+            if (object.hoverColorIndex == -1)
+                return boost::none;
+            return mHoverColors[object.hoverColorIndex];
+        }
 
         int32_t width();
         int32_t height();
 
     private:
         std::vector<std::vector<LevelObject>> mData;
-        int32_t mWidth;
-        int32_t mHeight;
-
-        friend std::vector<LevelObject>& get(int32_t x, int32_t y, LevelObjects& obj);
+        std::vector<int32_t> mOccupied; ///< indices into mData of the tiles add() has been called on since the last clear()
+        std::vector<Cel::Colour> mHoverColors;
+        int32_t mWidth = 0;
+        int32_t mHeight = 0;
     };
 }
 
@@ -1,13 +1,17 @@
 #pragma once
 
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "atlas.h"
 
 struct SDL_Cursor;
 struct SDL_Surface;
 
 namespace Render
 {
-    typedef void* Sprite;
+    typedef const AtlasRegion* Sprite;
     typedef SDL_Cursor* FACursor;
     typedef SDL_Surface* FASurface;
 
@@ -15,18 +19,21 @@ namespace Render
     {
     public:
         SpriteGroup(const std::string& path);
-        SpriteGroup(const std::vector<Sprite> sprites) : mSprites(sprites), mAnimLength(sprites.size()) {}
+        SpriteGroup(std::vector<AtlasRegion> frames) : mFrames(std::move(frames)), mAnimLength(mFrames.size()) {}
         void destroy();
 
-        Sprite& operator[](size_t index);
-        size_t size() { return mSprites.size(); }
+        Sprite operator[](size_t index);
+        size_t size() { return mFrames.size(); }
+
+        int32_t frameWidth(size_t index) const { return mFrames[index].width; }
+        int32_t frameHeight(size_t index) const { return mFrames[index].height; }
 
         size_t animLength() { return mAnimLength; }
 
         static void toPng(const std::string& celPath, const std::string& pngPath);
 
     private:
-        std::vector<Sprite> mSprites;
+        std::vector<AtlasRegion> mFrames;
         size_t mAnimLength;
     };
 
@@ -5,6 +5,7 @@
 #include "render.h"
 #include <iostream>
 #include <misc/assert.h>
+#include <misc/profiler.h>
 #include <string.h>
 
 struct nk_sdl_vertex
@@ -40,7 +41,7 @@ void nk_sdl_device_create(nk_gl_device& dev)
                                                            "   gl_Position = ProjMtx * vec4(Position.xy, 0, 1);\n"
                                                            "}\n";
     static const GLchar* fragment_shader = NK_SHADER_VERSION
-        R"(precision mediump float;
+        R"(precision highp float;
         uniform sampler2D Texture;
         in vec2 Frag_UV;
         in vec4 Frag_Color;
@@ -51,15 +52,18 @@ void nk_sdl_device_create(nk_gl_device& dev)
         uniform float h_color_a;
         uniform float imgW;
         uniform float imgH;
+        uniform vec4 uvRect;
         uniform int checkerboarded;
+        // Frag_UV is relative to the sprite, this maps it into the atlas page the sprite lives on
+        vec2 atlasUV(vec2 spriteUV) { return uvRect.xy + spriteUV * uvRect.zw; }
         void main(){
-             vec4 c = Frag_Color * texture(Texture, Frag_UV.st);
+             vec4 c = Frag_Color * texture(Texture, atlasUV(Frag_UV.st));
              if (c.w == 0. && h_color_a > 0.)
                 {
                   for (float i= -1.; i <= 1.; i++)
                     for (float j= -1.; j <= 1.; j++)
                         {
-                          vec4 n = texture(Texture, vec2 (Frag_UV.st.x + i/imgW, Frag_UV.st.y + j/imgH));
+                          vec4 n = texture(Texture, atlasUV(vec2 (Frag_UV.st.x + i/imgW, Frag_UV.st.y + j/imgH)));
                           if (n.w > 0. && (n.x > 0. || n.y > 0. || n.z > 0.))
                             c = vec4 (h_color_r, h_color_g, h_color_b, h_color_a);
                         }
@@ -107,6 +111,7 @@ void nk_sdl_device_create(nk_gl_device& dev)
     dev.uniform_checkerboarded = glGetUniformLocation(dev.prog, "checkerboarded");
     dev.imgW = glGetUniformLocation(dev.prog, "imgW");
     dev.imgH = glGetUniformLocation(dev.prog, "imgH");
+    dev.uniform_uv_rect = glGetUniformLocation(dev.prog, "uvRect");
     dev.uniform_tex = glGetUniformLocation(dev.prog, "Texture");
     dev.uniform_proj = glGetUniformLocation(dev.prog, "ProjMtx");
     dev.attrib_pos = glGetAttribLocation(dev.prog, "Position");
@@ -170,6 +175,8 @@ void nk_sdl_device_destroy(nk_gl_device& dev)
 
 void nk_sdl_render_dump(Render::SpriteCacheBase* cache, NuklearFrameDump& dump, SDL_Window* win)
 {
+    FA_PROFILE_ZONE("nk_sdl_render_dump");
+
     int width, height;
     int display_width, display_height;
     struct nk_vec2 scale;
@@ -240,7 +247,8 @@ void nk_sdl_render_dump(Render::SpriteCacheBase* cache, NuklearFrameDump& dump,
 
             Render::SpriteGroup* sprite = cache->get(cacheIndex);
             auto s = sprite->operator[](frameNum);
-            glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)s);
+            glBindTexture(GL_TEXTURE_2D, s->texture);
+            glUniform4f(dev.uniform_uv_rect, s->u, s->v, s->uSize, s->vSize);
             int32_t w, h;
             Render::spriteSize(s, w, h);
             int item_hl_color[] = {0xB9, 0xAA, 0x77};
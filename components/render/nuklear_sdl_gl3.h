@@ -28,6 +28,7 @@ struct nk_gl_device
     GLint uniform_checkerboarded;
     GLint imgW;
     GLint imgH;
+    GLint uniform_uv_rect;
     GLint uniform_proj;
     nk_handle font_tex;
 };
@@ -13,6 +13,7 @@
 
 #include "cel/pal.h"
 #include <boost/optional.hpp>
+#include <misc/misc.h>
 
 struct SDL_Cursor;
 struct SDL_Surface;
@@ -21,7 +22,7 @@ class SpriteGroup;
 
 namespace Render
 {
-    typedef void* Sprite;
+    typedef const AtlasRegion* Sprite;
     typedef SDL_Cursor* FACursor;
     typedef SDL_Surface* FASurface;
 
@@ -73,6 +74,7 @@ namespace Render
         int32_t windowWidth;
         int32_t windowHeight;
         bool fullscreen;
+        bool vsync = true;
     };
 
     struct NuklearGraphicsContext
@@ -122,6 +124,8 @@ namespace Render
     void spriteSize(const Sprite& sprite, int32_t& w, int32_t& h);
 
     SpriteGroup* loadTilesetSprite(const std::string& celPath, const std::string& minPath, bool top);
+    /// dist is the camera's, tickFraction is how far (0 to 1) we are into the tick after the one objs was filled in, moving
+    /// objects are drawn that much further along. The camera's dist should have the same done to it by the caller.
     void drawLevel(const Level::Level& level,
                    size_t minTopsHandle,
                    size_t minBottomsHandle,
@@ -132,9 +136,12 @@ namespace Render
                    int32_t y1,
                    int32_t x2,
                    int32_t y2,
-                   size_t dist);
+                   double dist,
+                   float tickFraction);
 
     Tile getTileByScreenPos(size_t x, size_t y, int32_t x1, int32_t y1, int32_t x2, int32_t y2, size_t dist);
+    /// Bounding box of the tiles drawLevel visits with the camera at the given position, objects on tiles outside it are never drawn
+    Misc::TileRect getVisibleTiles(int32_t viewportWidth, int32_t viewportHeight, int32_t x1, int32_t y1, int32_t x2, int32_t y2, size_t dist);
 
     void clear(int r = 0, int g = 0, int b = 255);
 }
@@ -2,11 +2,15 @@
 
 #include <complex>
 #include <iostream>
+#include <memory>
 
 #include <SDL.h>
 //#include <SDL_opengl.h>
 #include <SDL_image.h>
 
+#include "blit.h"
+#include "shaderprogram.h"
+#include "spritebatch.h"
 #include "sdl_gl_funcs.h"
 
 #include "../cel/celfile.h"
@@ -15,6 +19,7 @@
 #include "../level/level.h"
 #include <faio/fafileobject.h>
 #include <misc/assert.h>
+#include <misc/profiler.h>
 #include <misc/savePNG.h>
 #include <misc/stringops.h>
 
@@ -58,6 +63,9 @@ namespace Render
     SDL_Window* screen;
     SDL_Renderer* renderer;
     SDL_GLContext glContext;
+    TextureAtlas atlas;
+    std::unique_ptr<ShaderProgram> spriteShader;
+    SpriteBatch spriteBatch;
 
     void init(const std::string& title, const RenderSettings& settings, NuklearGraphicsContext& nuklearGraphics, nk_context* nk_ctx)
     {
@@ -99,7 +107,12 @@ namespace Render
             }
         }
 
-        renderer = SDL_CreateRenderer(screen, oglIdx, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+        if (settings.vsync)
+            rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+
+        renderer = SDL_CreateRenderer(screen, oglIdx, rendererFlags);
+        SDL_GL_SetSwapInterval(settings.vsync ? 1 : 0);
 
         initGlFuncs();
 
@@ -123,6 +136,9 @@ namespace Render
 
     void quit()
     {
+        spriteBatch.destroy();
+        spriteShader.reset();
+        atlas.destroy();
         SDL_GL_DeleteContext(glContext);
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(screen);
@@ -148,9 +164,8 @@ namespace Render
         return settings;
     }
 
-    GLuint getGLTexFromSurface(SDL_Surface* surf)
+    AtlasRegion addToAtlas(SDL_Surface* surf)
     {
-        GLenum data_fmt = GL_RGBA;
         /*Uint8 test = SDL_MapRGB(surf->format, 0xAA, 0xBB, 0xCC) & 0xFF;
         if (test == 0xAA) data_fmt = GL_RGB;
         else if (test == 0xCC) data_fmt = GL_BGR;//GL_BGR;
@@ -174,22 +189,12 @@ namespace Render
 
         debug_assert(surf->pitch == 4 * surf->w);
 
-        GLuint tex = 0;
-
-        glGenTextures(1, &tex);
-        glBindTexture(GL_TEXTURE_2D, tex);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, surf->w, surf->h, 0, data_fmt, GL_UNSIGNED_BYTE, surf->pixels);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        int32_t w, h;
-        spriteSize((Sprite)(intptr_t)tex, w, h);
+        AtlasRegion region = atlas.add(surf->w, surf->h, surf->pixels);
 
         if (!validFormat)
             SDL_FreeSurface(surf);
 
-        return tex;
+        return region;
     }
 
     void drawGui(NuklearFrameDump& dump, SpriteCacheBase* cache)
@@ -199,6 +204,7 @@ namespace Render
         // defaults everything back into a default state.
         // Make sure to either a.) save and restore or b.) reset your own state after
         // rendering the UI.
+        spriteBatch.flush();
         nk_sdl_render_dump(cache, dump, screen);
 
         glEnable(GL_BLEND); // see above comment
@@ -241,7 +247,7 @@ namespace Render
 
         if (Misc::StringUtils::ciEqual(extension, "cel") || Misc::StringUtils::ciEqual(extension, "cl2"))
         {
-            Cel::CelFile cel(path);
+            Cel::CelFile cel(path, Cel::FrameFormat::Indexed);
             widths.resize(cel.animLength());
             heights.resize(cel.animLength());
             for (int i = 0; i < cel.animLength(); ++i)
@@ -273,31 +279,40 @@ namespace Render
     }
 
     Cel::Colour getPixel(const SDL_Surface* s, int x, int y);
-    void setpixel(SDL_Surface* s, int x, int y, Cel::Colour c);
     SDL_Surface* createTransparentSurface(size_t width, size_t height);
     void drawFrame(SDL_Surface* s, int start_x, int start_y, const Cel::CelFrame& frame);
 
+    /// Only valid for surfaces in the format createTransparentSurface uses
+    ImageView imageView(SDL_Surface* s)
+    {
+        debug_assert(s->format->BytesPerPixel == 4);
+        return ImageView{static_cast<uint8_t*>(s->pixels), s->w, s->h, s->pitch};
+    }
+
+    /// Converts s to the format createTransparentSurface uses, if it isn't already. Frees s if a new surface is returned.
+    SDL_Surface* toRgbaSurface(SDL_Surface* s)
+    {
+        // SDL is stupid and interprets pixel formats by endianness, so on LE, it calls RGBA ABGR...
+        if (s->format->format == SDL_PIXELFORMAT_ABGR8888)
+            return s;
+
+        SDL_Surface* converted = SDL_ConvertSurfaceFormat(s, SDL_PIXELFORMAT_ABGR8888, 0);
+        if (converted == NULL)
+            printf("Could not convert surface: %s\n", SDL_GetError());
+        release_assert(converted);
+
+        SDL_FreeSurface(s);
+        return converted;
+    }
+
     SDL_Surface* loadNonCelImageTrans(const std::string& path, const std::string& extension, bool hasTrans, size_t transR, size_t transG, size_t transB)
     {
         SDL_Surface* tmp = loadNonCelImage(path, extension);
 
         if (hasTrans)
         {
-            SDL_Surface* src = tmp;
-            tmp = createTransparentSurface(src->w, src->h);
-
-            for (int x = 0; x < src->w; x++)
-            {
-                for (int y = 0; y < src->h; y++)
-                {
-                    Cel::Colour px = getPixel(src, x, y);
-                    if (!(px.r == transR && px.g == transG && px.b == transB))
-                    {
-                        setpixel(tmp, x, y, px);
-                    }
-                }
-            }
-            SDL_FreeSurface(src);
+            tmp = toRgbaSurface(tmp);
+            applyColourKey(imageView(tmp), transR, transG, transB);
         }
 
         return tmp;
@@ -315,8 +330,8 @@ namespace Render
         {
             SDL_Surface* tmp = loadNonCelImageTrans(path, extension, hasTrans, transR, transG, transB);
 
-            std::vector<Sprite> vec(1);
-            vec[0] = (Sprite)(intptr_t)getGLTexFromSurface(tmp);
+            std::vector<AtlasRegion> vec(1);
+            vec[0] = addToAtlas(tmp);
 
             SDL_FreeSurface(tmp);
 
@@ -329,29 +344,19 @@ namespace Render
     SpriteGroup* loadVanimSprite(const std::string& path, size_t vAnim, bool hasTrans, size_t transR, size_t transG, size_t transB)
     {
         std::string extension = getImageExtension(path);
-        SDL_Surface* original = loadNonCelImageTrans(path, extension, hasTrans, transR, transG, transB);
+        SDL_Surface* original = toRgbaSurface(loadNonCelImageTrans(path, extension, hasTrans, transR, transG, transB));
 
         SDL_Surface* tmp = createTransparentSurface(original->w, vAnim);
 
         std::cout << original->w;
 
-        std::vector<Sprite> vec;
+        std::vector<AtlasRegion> vec;
 
         for (size_t srcY = 0; srcY < (size_t)original->h - 1; srcY += vAnim)
         {
-            for (size_t x = 0; x < (size_t)original->w; x++)
-            {
-                for (size_t y = 0; y < vAnim; y++)
-                {
-                    if (srcY + y < (size_t)original->h)
-                    {
-                        Cel::Colour px = getPixel(original, x, srcY + y);
-                        setpixel(tmp, x, y, px);
-                    }
-                }
-            }
+            blitCopy(imageView(tmp), 0, 0, imageView(original), 0, srcY, original->w, vAnim);
 
-            vec.push_back((Render::Sprite)(intptr_t)getGLTexFromSurface(tmp));
+            vec.push_back(addToAtlas(tmp));
 
             clearTransparentSurface(tmp);
         }
@@ -366,7 +371,7 @@ namespace Render
         const std::string& path, size_t width, size_t height, size_t tileWidth, size_t tileHeight, bool hasTrans, size_t transR, size_t transG, size_t transB)
     {
         std::string extension = getImageExtension(path);
-        SDL_Surface* original = loadNonCelImageTrans(path, extension, hasTrans, transR, transG, transB);
+        SDL_Surface* original = toRgbaSurface(loadNonCelImageTrans(path, extension, hasTrans, transR, transG, transB));
         SDL_Surface* tmp = createTransparentSurface(width, height);
 
         size_t srcX = 0;
@@ -376,14 +381,7 @@ namespace Render
 
         while (true)
         {
-            for (size_t y = 0; y < tileHeight; y += 1)
-            {
-                for (size_t x = 0; x < tileWidth; x += 1)
-                {
-                    Cel::Colour px = getPixel(original, srcX + x, srcY + y);
-                    setpixel(tmp, dstX + x, dstY + y, px);
-                }
-            }
+            blitCopy(imageView(tmp), dstX, dstY, imageView(original), srcX, srcY, tileWidth, tileHeight);
 
             srcX += tileWidth;
             if (srcX >= (size_t)original->w)
@@ -406,8 +404,8 @@ namespace Render
                 break;
         }
 
-        std::vector<Sprite> vec(1);
-        vec[0] = (Sprite)(intptr_t)getGLTexFromSurface(tmp);
+        std::vector<AtlasRegion> vec(1);
+        vec[0] = addToAtlas(tmp);
 
         SDL_FreeSurface(original);
         SDL_FreeSurface(tmp);
@@ -440,8 +438,8 @@ namespace Render
             x += cel[i].mWidth;
         }
 
-        std::vector<Sprite> vec(1);
-        vec[0] = (Sprite)(intptr_t)getGLTexFromSurface(surface);
+        std::vector<AtlasRegion> vec(1);
+        vec[0] = addToAtlas(surface);
 
         SDL_FreeSurface(surface);
 
@@ -451,7 +449,7 @@ namespace Render
     SpriteGroup* loadTiledTexture(const std::string& sourcePath, size_t width, size_t height, bool hasTrans, size_t transR, size_t transG, size_t transB)
     {
         std::string extension = getImageExtension(sourcePath);
-        SDL_Surface* tile = loadNonCelImageTrans(sourcePath, extension, hasTrans, transR, transG, transB);
+        SDL_Surface* tile = toRgbaSurface(loadNonCelImageTrans(sourcePath, extension, hasTrans, transR, transG, transB));
         SDL_Surface* texture = createTransparentSurface(width, height);
 
         int dx = tile->w;
@@ -461,19 +459,12 @@ namespace Render
         {
             for (size_t x = 0; x < width; x += dx)
             {
-                for (size_t sy = 0; sy < (size_t)tile->h && (y + sy) < height; sy++)
-                {
-                    for (size_t sx = 0; sx < (size_t)tile->w && (x + sx) < width; sx++)
-                    {
-                        Cel::Colour px = getPixel(tile, sx, sy);
-                        setpixel(texture, x + sx, y + sy, px);
-                    }
-                }
+                blitCopy(imageView(texture), x, y, imageView(tile), 0, 0, tile->w, tile->h);
             }
         }
 
-        std::vector<Sprite> vec(1);
-        vec[0] = (Sprite)(intptr_t)getGLTexFromSurface(texture);
+        std::vector<AtlasRegion> vec(1);
+        vec[0] = addToAtlas(texture);
 
         SDL_FreeSurface(texture);
         SDL_FreeSurface(tile);
@@ -486,8 +477,8 @@ namespace Render
         std::string extension = getImageExtension(path);
         SDL_Surface* image = loadNonCelImage(path, extension);
 
-        std::vector<Sprite> vec(1);
-        vec[0] = (Sprite)(intptr_t)getGLTexFromSurface(image);
+        std::vector<AtlasRegion> vec(1);
+        vec[0] = addToAtlas(image);
 
         SDL_FreeSurface(image);
 
@@ -542,8 +533,8 @@ namespace Render
         // SDL_Texture *tex = SDL_CreateTextureFromSurface(renderer, surface);
         // SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
 
-        std::vector<Sprite> vec(1);
-        vec[0] = (Sprite)(intptr_t)getGLTexFromSurface(surface);
+        std::vector<AtlasRegion> vec(1);
+        vec[0] = addToAtlas(surface);
 
         SDL_FreeSurface(surface);
 
@@ -552,11 +543,9 @@ namespace Render
 
     bool once = false;
 
-    GLuint vao = 0;
-    GLuint shader_programme = 0;
     GLuint texture = 0;
 
-    void draw()
+    void initSpriteShader()
     {
         if (!once)
         {
@@ -566,85 +555,11 @@ namespace Render
 
             once = true;
 
-            float points[] = {0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 0};
-
-            float colours[] = {0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1};
-
-            GLuint vbo = 0;
-            glGenBuffers(1, &vbo);
-            glBindBuffer(GL_ARRAY_BUFFER, vbo);
-            glBufferData(GL_ARRAY_BUFFER, 18 * sizeof(float), points, GL_STATIC_DRAW);
-
-            GLuint uvs_vbo = 0;
-            glGenBuffers(1, &uvs_vbo);
-            glBindBuffer(GL_ARRAY_BUFFER, uvs_vbo);
-            glBufferData(GL_ARRAY_BUFFER, 12 * sizeof(float), colours, GL_STATIC_DRAW);
-
-            glGenVertexArrays(1, &vao);
-            glBindVertexArray(vao);
-            glBindBuffer(GL_ARRAY_BUFFER, vbo);
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-            glBindBuffer(GL_ARRAY_BUFFER, uvs_vbo);
-            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, NULL);
-
-            glEnableVertexAttribArray(0);
-            glEnableVertexAttribArray(1);
-
-            std::string src = Misc::StringUtils::readAsString("resources/shaders/basic.vert");
-            const GLchar* srcPtr = src.c_str();
-
-            GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-            glShaderSource(vs, 1, &srcPtr, NULL);
-            glCompileShader(vs);
-
-            GLint isCompiled = 0;
-            glGetShaderiv(vs, GL_COMPILE_STATUS, &isCompiled);
-            if (isCompiled == GL_FALSE)
-            {
-                GLint maxLength = 0;
-                glGetShaderiv(vs, GL_INFO_LOG_LENGTH, &maxLength);
-
-                // The maxLength includes the NULL character
-                std::vector<GLchar> errorLog(maxLength);
-                glGetShaderInfoLog(vs, maxLength, &maxLength, &errorLog[0]);
-
-                std::cout << &errorLog[0] << std::endl;
-
-                // Provide the infolog in whatever manor you deem best.
-                // Exit with failure.
-                glDeleteShader(vs); // Don't leak the shader.
-                return;
-            }
-
-            src = Misc::StringUtils::readAsString("resources/shaders/basic.frag");
-            srcPtr = src.c_str();
-
-            GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
-            glShaderSource(fs, 1, &srcPtr, NULL);
-            glCompileShader(fs);
-
-            glGetShaderiv(fs, GL_COMPILE_STATUS, &isCompiled);
-            if (isCompiled == GL_FALSE)
-            {
-                GLint maxLength = 0;
-                glGetShaderiv(fs, GL_INFO_LOG_LENGTH, &maxLength);
-
-                // The maxLength includes the NULL character
-                std::vector<GLchar> errorLog(maxLength);
-                glGetShaderInfoLog(fs, maxLength, &maxLength, &errorLog[0]);
-
-                std::cout << &errorLog[0] << std::endl;
-
-                // Provide the infolog in whatever manor you deem best.
-                // Exit with failure.
-                glDeleteShader(fs); // Don't leak the shader.
+            spriteShader.reset(new ShaderProgram("resources/shaders/basic.vert", "resources/shaders/basic.frag"));
+            if (!spriteShader->isValid())
                 return;
-            }
 
-            shader_programme = glCreateProgram();
-            glAttachShader(shader_programme, fs);
-            glAttachShader(shader_programme, vs);
-            glLinkProgram(shader_programme);
+            spriteBatch.init(*spriteShader);
 
             /*SDL_Surface* surf = SDL_LoadBMP("E:\\tom.bmp");
 
@@ -656,90 +571,14 @@ namespace Render
             SDL_FreeSurface(s);
             SDL_FreeSurface(surf);*/
         }
-
-        /*GLint loc = glGetUniformLocation(shader_programme, "width");
-        if (loc != -1)
-        {
-            glUniform1f(loc, WIDTH);
-        }
-        loc = glGetUniformLocation(shader_programme, "height");
-        if (loc != -1)
-        {
-            glUniform1f(loc, HEIGHT);
-        }
-
-        loc = glGetUniformLocation(shader_programme, "imgW");
-        if (loc != -1)
-        {
-            glUniform1f(loc, 150);
-        }
-        loc = glGetUniformLocation(shader_programme, "imgH");
-        if (loc != -1)
-        {
-            glUniform1f(loc, 100);
-        }
-
-        loc = glGetUniformLocation(shader_programme, "offsetX");
-        if (loc != -1)
-        {
-            glUniform1f(loc, 150);
-        }
-        loc = glGetUniformLocation(shader_programme, "offsetY");
-        if (loc != -1)
-        {
-            glUniform1f(loc, 100);
-        }
-
-        //glClearColor(1.0f, 0.0f, 0.0f, 0.0f);
-        //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        glUseProgram(shader_programme);
-        glBindVertexArray(vao);
-        // draw points 0-3 from the currently bound VAO with current in-use shader
-        glDrawArrays(GL_TRIANGLES, 0, 6);*/
-
-        // drawAt(texture, 0, 0);
-
-        SDL_RenderPresent(renderer);
     }
 
-    void drawSprite(GLuint sprite, int32_t x, int32_t y, boost::optional<Cel::Colour> highlightColor)
+    void draw()
     {
-        glUseProgram(shader_programme);
-
-        auto setUniform = [](const char* name, double value) {
-            GLint loc = glGetUniformLocation(shader_programme, name);
-            if (loc != -1)
-            {
-                glUniform1f(loc, value);
-            }
-        };
-
-        setUniform("width", WIDTH);
-        setUniform("height", HEIGHT);
-
-        int32_t w, h;
-        spriteSize((Sprite)(intptr_t)sprite, w, h);
-
-        setUniform("imgW", w);
-        setUniform("imgH", h);
-        setUniform("offsetX", x);
-        setUniform("offsetY", y);
-        if (auto c = highlightColor)
-        {
-            setUniform("h_color_r", c->r / 255.f);
-            setUniform("h_color_g", c->g / 255.f);
-            setUniform("h_color_b", c->b / 255.f);
-            setUniform("h_color_a", 1.0f);
-        }
-        else
-            setUniform("h_color_a", 0.0f);
-
-        glBindTexture(GL_TEXTURE_2D, sprite);
+        initSpriteShader();
+        spriteBatch.flush();
 
-        glBindVertexArray(vao);
-        // draw points 0-3 from the currently bound VAO with current in-use shader
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        SDL_RenderPresent(renderer);
     }
 
     void handleEvents()
@@ -753,7 +592,18 @@ namespace Render
 
     void drawSprite(const Sprite& sprite, int32_t x, int32_t y, boost::optional<Cel::Colour> highlightColor)
     {
-        drawSprite((GLuint)(intptr_t)sprite, x, y, highlightColor);
+        initSpriteShader();
+
+        uint8_t highlight[4] = {0, 0, 0, 0};
+        if (auto c = highlightColor)
+        {
+            highlight[0] = c->r;
+            highlight[1] = c->g;
+            highlight[2] = c->b;
+            highlight[3] = 255;
+        }
+
+        spriteBatch.add(*sprite, x, y, highlight);
     }
 
     constexpr auto tileHeight = 32;
@@ -769,23 +619,19 @@ namespace Render
     {
         Cel::CelFile cel(path);
 
-        for (int32_t i = 0; i < cel.numFrames(); i++)
-        {
-            SDL_Surface* s = createTransparentSurface(cel[i].mWidth, cel[i].mHeight);
-            drawFrame(s, 0, 0, cel[i]);
+        // Decoding is spread across the thread pool, only the uploads have to happen here on the render thread
+        std::vector<Cel::RgbaFrame> frames = cel.decodeRgba();
 
-            mSprites.push_back((Render::Sprite)(intptr_t)getGLTexFromSurface(s)); // SDL_CreateTextureFromSurface(renderer, s));
-
-            SDL_FreeSurface(s);
-        }
+        for (const auto& frame : frames)
+            mFrames.push_back(atlas.add(frame.width, frame.height, frame.pixels.data()));
 
         mAnimLength = cel.animLength();
     }
 
-    Sprite& SpriteGroup::operator[](size_t index)
+    Sprite SpriteGroup::operator[](size_t index)
     {
-        debug_assert(index < mSprites.size());
-        return mSprites[index];
+        debug_assert(index < mFrames.size());
+        return &mFrames[index];
     }
 
     void SpriteGroup::toPng(const std::string& celPath, const std::string& pngPath)
@@ -825,11 +671,8 @@ namespace Render
 
     void SpriteGroup::destroy()
     {
-        for (size_t i = 0; i < mSprites.size(); i++)
-        {
-            GLuint tex = (GLuint)(intptr_t)mSprites[i];
-            glDeleteTextures(1, &tex);
-        }
+        for (const auto& frame : mFrames)
+            atlas.release(frame);
     }
 
     void drawMinPillarTop(SDL_Surface* s, int x, int y, const std::vector<int16_t>& pillar, Cel::CelFile& tileset);
@@ -837,12 +680,12 @@ namespace Render
 
     SpriteGroup* loadTilesetSprite(const std::string& celPath, const std::string& minPath, bool top)
     {
-        Cel::CelFile cel(celPath);
+        Cel::CelFile cel(celPath, Cel::FrameFormat::Indexed);
         Level::Min min(minPath);
 
         SDL_Surface* newPillar = createTransparentSurface(64, 256);
 
-        std::vector<Sprite> newMin(min.size() - 1);
+        std::vector<AtlasRegion> newMin(min.size() - 1);
 
         for (size_t i = 0; i < min.size() - 1; i++)
         {
@@ -853,7 +696,7 @@ namespace Render
             else
                 drawMinPillarBase(newPillar, 0, 0, min[i], cel);
 
-            newMin[i] = (Sprite)(intptr_t)getGLTexFromSurface(newPillar); // NULL;// SDL_CreateTextureFromSurface(renderer, newPillar);
+            newMin[i] = addToAtlas(newPillar);
         }
 
         SDL_FreeSurface(newPillar);
@@ -863,15 +706,8 @@ namespace Render
 
     void spriteSize(const Sprite& sprite, int32_t& w, int32_t& h)
     {
-        GLint tmpW = 0, tmpH = 0;
-
-        glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)sprite);
-
-        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &tmpW);
-        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &tmpH);
-        // SDL_QueryTexture((SDL_Texture*)sprite, NULL, NULL, &tmpW, &tmpH);
-        w = tmpW;
-        h = tmpH;
+        w = sprite->width;
+        h = sprite->height;
     }
 
     void clear(int r, int g, int b)
@@ -901,45 +737,6 @@ namespace Render
         return s;
     }
 
-    void setpixel(SDL_Surface* surface, int x, int y, Cel::Colour c)
-    {
-        Uint32 pixel = SDL_MapRGBA(surface->format, c.r, c.g, c.b, ((int)c.visible) * 255);
-
-        int bpp = surface->format->BytesPerPixel;
-        // Here p is the address to the pixel we want to set
-        Uint8* p = (Uint8*)surface->pixels + y * surface->pitch + x * bpp;
-
-        switch (bpp)
-        {
-            case 1:
-                *p = pixel;
-                break;
-
-            case 2:
-                *(Uint16*)p = pixel;
-                break;
-
-            case 3:
-                if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
-                {
-                    p[0] = (pixel >> 16) & 0xff;
-                    p[1] = (pixel >> 8) & 0xff;
-                    p[2] = pixel & 0xff;
-                }
-                else
-                {
-                    p[0] = pixel & 0xff;
-                    p[1] = (pixel >> 8) & 0xff;
-                    p[2] = (pixel >> 16) & 0xff;
-                }
-                break;
-
-            case 4:
-                *(Uint32*)p = pixel;
-                break;
-        }
-    }
-
     Cel::Colour getPixel(const SDL_Surface* s, int x, int y)
     {
         Uint32 pix;
@@ -981,15 +778,8 @@ namespace Render
 
     void drawFrame(SDL_Surface* s, int start_x, int start_y, const Cel::CelFrame& frame)
     {
-        for (int32_t x = 0; x < frame.mWidth; x++)
-        {
-            for (int32_t y = 0; y < frame.mHeight; y++)
-            {
-                auto& c = frame[x][y];
-                if (c.visible)
-                    setpixel(s, start_x + x, start_y + y, c);
-            }
-        }
+        std::vector<Cel::Colour> pixels = frame.toRgba();
+        blitColoursMasked(imageView(s), start_x, start_y, pixels.data(), frame.mWidth, frame.mHeight);
     }
 
     void drawMinTile(SDL_Surface* s, Cel::CelFile& f, int x, int y, int16_t l, int16_t r)
@@ -1058,7 +848,7 @@ namespace Render
         return {x.quot, y.quot, x.rem > y.rem ? TileHalf::right : TileHalf::left};
     }
 
-    static Misc::Point pointBetween(const Tile& start, const Tile& finish, const size_t& percent)
+    static Misc::Point pointBetween(const Tile& start, const Tile& finish, double percent)
     {
         auto pointA = tileTopPoint(start);
         auto pointB = tileTopPoint(finish);
@@ -1068,7 +858,7 @@ namespace Render
     static void drawMovingSprite(const Sprite& sprite,
                                  const Tile& start,
                                  const Tile& finish,
-                                 size_t dist,
+                                 double dist,
                                  const Misc::Point& toScreen,
                                  boost::optional<Cel::Colour> highlightColor = boost::none)
     {
@@ -1080,12 +870,14 @@ namespace Render
     }
 
     constexpr auto bottomMenuSize = 144; // TODO: pass it as a variable
-    Misc::Point worldToScreenVector(const Tile& start, const Tile& finish, size_t dist)
+    static Misc::Point worldToScreenVector(const Tile& start, const Tile& finish, double dist, int32_t viewportWidth, int32_t viewportHeight)
     {
         // centering takes in accord bottom menu size to be consistent with original game centering
-        return Misc::Point{WIDTH / 2, (HEIGHT - bottomMenuSize) / 2} - pointBetween(start, finish, dist);
+        return Misc::Point{viewportWidth / 2, (viewportHeight - bottomMenuSize) / 2} - pointBetween(start, finish, dist);
     }
 
+    Misc::Point worldToScreenVector(const Tile& start, const Tile& finish, double dist) { return worldToScreenVector(start, finish, dist, WIDTH, HEIGHT); }
+
     Tile getTileByScreenPos(size_t x, size_t y, int32_t x1, int32_t y1, int32_t x2, int32_t y2, size_t dist)
     {
         auto toScreen = worldToScreenVector({x1, y1}, {x2, y2}, dist);
@@ -1094,6 +886,31 @@ namespace Render
 
     constexpr auto staticObjectHeight = 256;
 
+    Misc::TileRect getVisibleTiles(int32_t viewportWidth, int32_t viewportHeight, int32_t x1, int32_t y1, int32_t x2, int32_t y2, size_t dist)
+    {
+        auto toScreen = worldToScreenVector({x1, y1}, {x2, y2}, dist, viewportWidth, viewportHeight);
+
+        // The screen area drawObjectsByTiles walks over, with a tile to spare on each side. Screen to tile is linear,
+        // so the corners of that area are the extremes.
+        Misc::Point corners[] = {{-3 * tileWidth, -3 * tileHeight},
+                                 {viewportWidth + 2 * tileWidth, -3 * tileHeight},
+                                 {-3 * tileWidth, viewportHeight + staticObjectHeight + tileHeight},
+                                 {viewportWidth + 2 * tileWidth, viewportHeight + staticObjectHeight + tileHeight}};
+
+        Tile first = getTileFromScreenCoords(corners[0], toScreen);
+        Misc::TileRect rect{first.x, first.y, first.x, first.y};
+        for (const auto& corner : corners)
+        {
+            Tile tile = getTileFromScreenCoords(corner, toScreen);
+            rect.minX = std::min(rect.minX, tile.x);
+            rect.minY = std::min(rect.minY, tile.y);
+            rect.maxX = std::max(rect.maxX, tile.x);
+            rect.maxY = std::max(rect.maxY, tile.y);
+        }
+
+        return rect;
+    }
+
     template <typename ProcessTileFunc> void drawObjectsByTiles(const Misc::Point& toScreen, ProcessTileFunc processTile)
     {
         Misc::Point start{-2 * tileWidth, -2 * tileHeight};
@@ -1137,8 +954,11 @@ namespace Render
                    int32_t y1,
                    int32_t x2,
                    int32_t y2,
-                   size_t dist)
+                   double dist,
+                   float tickFraction)
     {
+        FA_PROFILE_ZONE("Render::drawLevel");
+
         auto toScreen = worldToScreenVector({x1, y1}, {x2, y2}, dist);
         SpriteGroup* minBottoms = cache->get(minBottomsHandle);
         auto isInvalidTile = [&](const Tile& tile) {
@@ -1153,8 +973,8 @@ namespace Render
                 return drawAtTile((*minBottoms)[0], topLeft, tileWidth, staticObjectHeight);
             }
 
-            size_t index = level[tile.x][tile.y].index();
-            if (index < minBottoms->size())
+            int32_t index = level.pillarIndex(tile.x, tile.y);
+            if (index >= 0 && size_t(index) < minBottoms->size())
                 drawAtTile((*minBottoms)[index], topLeft, tileWidth, staticObjectHeight); // all static objects have the same sprite size
         });
 
@@ -1166,27 +986,23 @@ namespace Render
             if (isInvalidTile(tile))
                 return;
 
-            size_t index = level[tile.x][tile.y].index();
-            if (index < minTops->size())
+            int32_t index = level.pillarIndex(tile.x, tile.y);
+            if (index >= 0 && size_t(index) < minTops->size())
                 drawAtTile((*minTops)[index], topLeft, tileWidth, staticObjectHeight);
 
-            auto& itemsForTile = items[tile.x][tile.y];
-            for (auto& item : itemsForTile)
+            for (const auto& item : items.objects(tile.x, tile.y))
             {
                 int32_t w, h;
                 auto sprite = (*cache->get(item.spriteCacheIndex))[item.spriteFrame];
                 spriteSize(sprite, w, h);
-                drawAtTile(sprite, topLeft, w, h, item.hoverColor);
+                drawAtTile(sprite, topLeft, w, h, items.hoverColor(item));
             }
 
-            auto& objsForTile = objs[tile.x][tile.y];
-            for (auto& obj : objsForTile)
+            for (const auto& obj : objs.objects(tile.x, tile.y))
             {
-                if (obj.valid)
-                {
-                    auto sprite = cache->get(obj.spriteCacheIndex);
-                    drawMovingSprite((*sprite)[obj.spriteFrame], tile, {obj.x2, obj.y2}, obj.dist, toScreen, obj.hoverColor);
-                }
+                auto sprite = cache->get(obj.spriteCacheIndex);
+                double objDist = std::min(obj.dist + tickFraction * obj.distPerTick, 100.0f);
+                drawMovingSprite((*sprite)[obj.spriteFrame], tile, {obj.x2, obj.y2}, objDist, toScreen, objs.hoverColor(obj));
             }
         });
 
@@ -5,8 +5,10 @@
 PFNGLGENBUFFERSPROC glGenBuffers;
 PFNGLBINDBUFFERPROC glBindBuffer;
 PFNGLBUFFERDATAPROC glBufferData;
+PFNGLBUFFERSUBDATAPROC glBufferSubData;
 PFNGLGENVERTEXARRAYSPROC glGenVertexArrays;
 PFNGLBINDVERTEXARRAYPROC glBindVertexArray;
+PFNGLDELETEVERTEXARRAYSPROC glDeleteVertexArrays;
 PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArray;
 PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointer;
 PFNGLCREATESHADERPROC glCreateShader;
@@ -21,6 +23,7 @@ PFNGLGETSHADERINFOLOGPROC glGetShaderInfoLog;
 PFNGLDELETESHADERPROC glDeleteShader;
 PFNGLGETUNIFORMLOCATIONPROC glGetUniformLocation;
 PFNGLUNIFORM1FPROC glUniform1f;
+PFNGLUNIFORM4FPROC glUniform4f;
 PFNGLGETPROGRAMIVPROC glGetProgramiv;
 PFNGLGETATTRIBLOCATIONPROC glGetAttribLocation;
 PFNGLDETACHSHADERPROC glDetachShader;
@@ -32,6 +35,11 @@ PFNGLMAPBUFFERPROC glMapBuffer;
 PFNGLUNMAPBUFFERPROC glUnmapBuffer;
 PFNGLBLENDEQUATIONPROC glBlendEquation;
 PFNGLACTIVETEXTUREPROC glActiveTexture;
+PFNGLGETPROGRAMINFOLOGPROC glGetProgramInfoLog;
+PFNGLGETACTIVEUNIFORMPROC glGetActiveUniform;
+PFNGLGETUNIFORMBLOCKINDEXPROC glGetUniformBlockIndex;
+PFNGLUNIFORMBLOCKBINDINGPROC glUniformBlockBinding;
+PFNGLBINDBUFFERBASEPROC glBindBufferBase;
 
 void initGlFuncs()
 {
@@ -43,10 +51,14 @@ void initGlFuncs()
     memcpy(&glBindBuffer, &tmp, sizeof(void*));
     tmp = SDL_GL_GetProcAddress("glBufferData");
     memcpy(&glBufferData, &tmp, sizeof(void*));
+    tmp = SDL_GL_GetProcAddress("glBufferSubData");
+    memcpy(&glBufferSubData, &tmp, sizeof(void*));
     tmp = SDL_GL_GetProcAddress("glGenVertexArrays");
     memcpy(&glGenVertexArrays, &tmp, sizeof(void*));
     tmp = SDL_GL_GetProcAddress("glBindVertexArray");
     memcpy(&glBindVertexArray, &tmp, sizeof(void*));
+    tmp = SDL_GL_GetProcAddress("glDeleteVertexArrays");
+    memcpy(&glDeleteVertexArrays, &tmp, sizeof(void*));
     tmp = SDL_GL_GetProcAddress("glEnableVertexAttribArray");
     memcpy(&glEnableVertexAttribArray, &tmp, sizeof(void*));
     tmp = SDL_GL_GetProcAddress("glVertexAttribPointer");
@@ -75,6 +87,8 @@ void initGlFuncs()
     memcpy(&glGetUniformLocation, &tmp, sizeof(void*));
     tmp = SDL_GL_GetProcAddress("glUniform1f");
     memcpy(&glUniform1f, &tmp, sizeof(void*));
+    tmp = SDL_GL_GetProcAddress("glUniform4f");
+    memcpy(&glUniform4f, &tmp, sizeof(void*));
     tmp = SDL_GL_GetProcAddress("glGetProgramiv");
     memcpy(&glGetProgramiv, &tmp, sizeof(void*));
     tmp = SDL_GL_GetProcAddress("glGetAttribLocation");
@@ -97,4 +111,14 @@ void initGlFuncs()
     memcpy(&glBlendEquation, &tmp, sizeof(void*));
     tmp = SDL_GL_GetProcAddress("glActiveTexture");
     memcpy(&glActiveTexture, &tmp, sizeof(void*));
+    tmp = SDL_GL_GetProcAddress("glGetProgramInfoLog");
+    memcpy(&glGetProgramInfoLog, &tmp, sizeof(void*));
+    tmp = SDL_GL_GetProcAddress("glGetActiveUniform");
+    memcpy(&glGetActiveUniform, &tmp, sizeof(void*));
+    tmp = SDL_GL_GetProcAddress("glGetUniformBlockIndex");
+    memcpy(&glGetUniformBlockIndex, &tmp, sizeof(void*));
+    tmp = SDL_GL_GetProcAddress("glUniformBlockBinding");
+    memcpy(&glUniformBlockBinding, &tmp, sizeof(void*));
+    tmp = SDL_GL_GetProcAddress("glBindBufferBase");
+    memcpy(&glBindBufferBase, &tmp, sizeof(void*));
 }
\ No newline at end of file
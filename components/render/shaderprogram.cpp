@@ -0,0 +1,119 @@
+#include "shaderprogram.h"
+
+#include <iostream>
+#include <vector>
+
+#include "sdl_gl_funcs.h"
+#include <misc/stringops.h>
+
+namespace Render
+{
+    /// @return 0 if the shader didn't compile, after printing the info log
+    static GLuint compileShader(GLenum type, const std::string& path)
+    {
+        std::string src = Misc::StringUtils::readAsString(path);
+        const GLchar* srcPtr = src.c_str();
+
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &srcPtr, NULL);
+        glCompileShader(shader);
+
+        GLint isCompiled = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
+        if (isCompiled == GL_FALSE)
+        {
+            GLint maxLength = 0;
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
+
+            // The maxLength includes the NULL character
+            std::vector<GLchar> errorLog(maxLength + 1);
+            glGetShaderInfoLog(shader, maxLength, &maxLength, &errorLog[0]);
+
+            std::cout << path << ": " << &errorLog[0] << std::endl;
+
+            glDeleteShader(shader);
+            return 0;
+        }
+
+        return shader;
+    }
+
+    ShaderProgram::ShaderProgram(const std::string& vertexPath, const std::string& fragmentPath)
+    {
+        GLuint vs = compileShader(GL_VERTEX_SHADER, vertexPath);
+        GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentPath);
+
+        if (vs && fs)
+        {
+            mProgram = glCreateProgram();
+            glAttachShader(mProgram, fs);
+            glAttachShader(mProgram, vs);
+            glLinkProgram(mProgram);
+
+            GLint isLinked = 0;
+            glGetProgramiv(mProgram, GL_LINK_STATUS, &isLinked);
+            if (isLinked == GL_FALSE)
+            {
+                GLint maxLength = 0;
+                glGetProgramiv(mProgram, GL_INFO_LOG_LENGTH, &maxLength);
+
+                std::vector<GLchar> errorLog(maxLength + 1);
+                glGetProgramInfoLog(mProgram, maxLength, &maxLength, &errorLog[0]);
+
+                std::cout << vertexPath << ", " << fragmentPath << ": " << &errorLog[0] << std::endl;
+
+                glDeleteProgram(mProgram);
+                mProgram = 0;
+            }
+        }
+
+        if (vs)
+            glDeleteShader(vs);
+        if (fs)
+            glDeleteShader(fs);
+
+        if (!mProgram)
+            return;
+
+        GLint uniformCount = 0;
+        GLint maxNameLength = 0;
+        glGetProgramiv(mProgram, GL_ACTIVE_UNIFORMS, &uniformCount);
+        glGetProgramiv(mProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+        std::vector<GLchar> name(maxNameLength + 1);
+        for (GLint i = 0; i < uniformCount; i++)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(mProgram, GLuint(i), GLsizei(name.size()), &length, &size, &type, &name[0]);
+
+            // uniforms inside blocks are active but have no location
+            GLint location = glGetUniformLocation(mProgram, &name[0]);
+            if (location != -1)
+                mUniformLocations[std::string(&name[0], length)] = location;
+        }
+    }
+
+    ShaderProgram::~ShaderProgram()
+    {
+        if (mProgram)
+            glDeleteProgram(mProgram);
+    }
+
+    int32_t ShaderProgram::uniformLocation(const std::string& name) const
+    {
+        auto it = mUniformLocations.find(name);
+        if (it == mUniformLocations.end())
+            return -1;
+
+        return it->second;
+    }
+
+    void ShaderProgram::bindUniformBlock(const std::string& name, uint32_t bindingPoint)
+    {
+        GLuint index = glGetUniformBlockIndex(mProgram, name.c_str());
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(mProgram, index, bindingPoint);
+    }
+}
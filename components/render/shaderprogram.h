@@ -0,0 +1,41 @@
+#ifndef RENDER_SHADERPROGRAM_H
+#define RENDER_SHADERPROGRAM_H
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+namespace Render
+{
+    ///
+    /// A linked vertex + fragment shader pair. The locations of all active uniforms are looked up once, right after linking,
+    /// so callers can fetch the ones they need up front and never call glGetUniformLocation while drawing.
+    /// Needs a current GL context for its whole lifetime.
+    ///
+    class ShaderProgram
+    {
+    public:
+        /// Compiles and links the shaders in the given files. On failure the info log is printed and isValid() returns false.
+        ShaderProgram(const std::string& vertexPath, const std::string& fragmentPath);
+        ~ShaderProgram();
+
+        ShaderProgram(const ShaderProgram&) = delete;
+        ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+        bool isValid() const { return mProgram != 0; }
+        uint32_t id() const { return mProgram; }
+
+        /// @return -1 if the program has no active uniform called name, same as glGetUniformLocation
+        int32_t uniformLocation(const std::string& name) const;
+
+        /// Connects the uniform block called name to a uniform buffer binding point. Does nothing if there is no such block.
+        void bindUniformBlock(const std::string& name, uint32_t bindingPoint);
+
+    private:
+        uint32_t mProgram = 0;
+        std::map<std::string, int32_t> mUniformLocations;
+    };
+}
+
+#endif
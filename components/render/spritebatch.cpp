@@ -0,0 +1,148 @@
+#include "spritebatch.h"
+
+#include <string.h>
+
+#include "atlas.h"
+#include "render.h"
+#include "sdl_gl_funcs.h"
+#include "shaderprogram.h"
+
+namespace Render
+{
+    constexpr size_t SpriteBatch::MAX_QUADS;
+    constexpr uint32_t SpriteBatch::VIEWPORT_BINDING;
+
+    void SpriteBatch::init(ShaderProgram& program)
+    {
+        mProgram = program.id();
+        mVertices.reserve(MAX_QUADS * 4);
+
+        glUseProgram(mProgram);
+        GLint texLoc = program.uniformLocation("tex");
+        if (texLoc != -1)
+            glUniform1i(texLoc, 0);
+
+        // std140 pads a lone vec2 block out to 16 bytes
+        program.bindUniformBlock("Viewport", VIEWPORT_BINDING);
+        glGenBuffers(1, &mViewportUbo);
+        glBindBuffer(GL_UNIFORM_BUFFER, mViewportUbo);
+        glBufferData(GL_UNIFORM_BUFFER, 4 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, VIEWPORT_BINDING, mViewportUbo);
+        mViewportWidth = mViewportHeight = 0;
+
+        // every quad is two triangles over its own four vertices, so the indices never change
+        std::vector<uint16_t> indices(MAX_QUADS * 6);
+        for (size_t i = 0; i < MAX_QUADS; i++)
+        {
+            uint16_t first = uint16_t(i * 4);
+            uint16_t quad[] = {first, uint16_t(first + 1), uint16_t(first + 2), first, uint16_t(first + 2), uint16_t(first + 3)};
+            memcpy(&indices[i * 6], quad, sizeof(quad));
+        }
+
+        glGenVertexArrays(1, &mVao);
+        glBindVertexArray(mVao);
+
+        glGenBuffers(1, &mVbo);
+        glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+        glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * 4 * sizeof(Vertex), NULL, GL_STREAM_DRAW);
+
+        glGenBuffers(1, &mEbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEbo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, highlightColour));
+
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glEnableVertexAttribArray(2);
+
+        glBindVertexArray(0);
+    }
+
+    void SpriteBatch::destroy()
+    {
+        mVertices.clear();
+
+        glDeleteBuffers(1, &mVbo);
+        glDeleteBuffers(1, &mEbo);
+        glDeleteBuffers(1, &mViewportUbo);
+        glDeleteVertexArrays(1, &mVao);
+        mVao = mVbo = mEbo = mViewportUbo = 0;
+    }
+
+    void SpriteBatch::updateViewport()
+    {
+        if (WIDTH == mViewportWidth && HEIGHT == mViewportHeight)
+            return;
+
+        mViewportWidth = WIDTH;
+        mViewportHeight = HEIGHT;
+
+        float viewport[4] = {float(WIDTH), float(HEIGHT), 0.0f, 0.0f};
+        glBindBuffer(GL_UNIFORM_BUFFER, mViewportUbo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(viewport), viewport);
+    }
+
+    void SpriteBatch::add(const AtlasRegion& sprite, int32_t x, int32_t y, const uint8_t highlightColour[4])
+    {
+        if (sprite.texture != mTexture || mVertices.size() == MAX_QUADS * 4)
+        {
+            flush();
+            mTexture = sprite.texture;
+        }
+
+        float left = float(x);
+        float top = float(y);
+        float right = float(x + sprite.width);
+        float bottom = float(y + sprite.height);
+
+        float u0 = sprite.u;
+        float v0 = sprite.v;
+        float u1 = sprite.u + sprite.uSize;
+        float v1 = sprite.v + sprite.vSize;
+
+        Vertex corners[] = {
+            {left, top, u0, v0, {0, 0, 0, 0}},
+            {right, top, u1, v0, {0, 0, 0, 0}},
+            {right, bottom, u1, v1, {0, 0, 0, 0}},
+            {left, bottom, u0, v1, {0, 0, 0, 0}},
+        };
+
+        for (auto& corner : corners)
+        {
+            memcpy(corner.highlightColour, highlightColour, sizeof(corner.highlightColour));
+            mVertices.push_back(corner);
+        }
+    }
+
+    void SpriteBatch::flush()
+    {
+        if (mVertices.empty())
+            return;
+
+        // never initialised, which happens if the sprite shader failed to compile
+        if (mVao == 0)
+        {
+            mVertices.clear();
+            return;
+        }
+
+        glUseProgram(mProgram);
+        updateViewport();
+
+        glBindTexture(GL_TEXTURE_2D, mTexture);
+        glBindVertexArray(mVao);
+
+        // orphan the old contents rather than waiting for the GPU to finish with them
+        glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+        glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * 4 * sizeof(Vertex), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, mVertices.size() * sizeof(Vertex), mVertices.data());
+
+        glDrawElements(GL_TRIANGLES, GLsizei(mVertices.size() / 4 * 6), GL_UNSIGNED_SHORT, NULL);
+
+        glBindVertexArray(0);
+        mVertices.clear();
+    }
+}
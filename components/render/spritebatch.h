@@ -0,0 +1,58 @@
+#ifndef RENDER_SPRITEBATCH_H
+#define RENDER_SPRITEBATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace Render
+{
+    struct AtlasRegion;
+    class ShaderProgram;
+
+    ///
+    /// Collects sprite quads in memory and draws them with as few draw calls as possible.
+    /// Quads are drawn in the order they were added. A draw call is issued whenever the next quad needs a different
+    /// texture (so sprites that share an atlas page share a draw call), when the buffer is full, and on flush().
+    /// Anything else that draws to the screen has to flush() the batch first, or it will end up underneath.
+    ///
+    class SpriteBatch
+    {
+    public:
+        static constexpr size_t MAX_QUADS = 4096;        ///< indices are 16 bit, so at most 16384 quads
+        static constexpr uint32_t VIEWPORT_BINDING = 0; ///< uniform buffer binding point of the Viewport block
+
+        /// program has to take the vertex layout and Viewport block in resources/shaders/basic.vert, and must outlive the batch
+        void init(ShaderProgram& program);
+        void destroy();
+
+        /// highlightColour is r, g, b, a for the outline drawn around the sprite, a = 0 means no outline
+        void add(const AtlasRegion& sprite, int32_t x, int32_t y, const uint8_t highlightColour[4]);
+        void flush();
+
+    private:
+        struct Vertex
+        {
+            float x; ///< screen position in pixels, origin at the top left
+            float y;
+            float u;
+            float v;
+            uint8_t highlightColour[4];
+        };
+
+        void updateViewport();
+
+        uint32_t mProgram = 0;
+        uint32_t mVao = 0;
+        uint32_t mVbo = 0;
+        uint32_t mEbo = 0;
+        uint32_t mViewportUbo = 0;
+        int32_t mViewportWidth = 0; ///< what's currently in mViewportUbo
+        int32_t mViewportHeight = 0;
+        uint32_t mTexture = 0; ///< texture of the quads currently in mVertices
+        std::vector<Vertex> mVertices;
+    };
+}
+
+#endif
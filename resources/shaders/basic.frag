@@ -1,26 +1,23 @@
 #version 320 es
-precision mediump float;
+precision highp float; // mediump can't address single texels in a 2048 wide atlas page
 
 in vec2 uv;
+in vec4 highlight; // outline colour, a = 0 for no outline
 out vec4 frag_colour;
 uniform sampler2D tex;
-uniform float h_color_r;
-uniform float h_color_g;
-uniform float h_color_b;
-uniform float h_color_a;
-uniform float imgW;
-uniform float imgH;
 
 void main() {
     vec4 c = texture(tex, uv);
-    if (c.w == 0. && h_color_a > 0.)
+    if (c.w == 0. && highlight.a > 0.)
     {
+      // uv is in atlas page space, so step by the page's texel size
+      vec2 texel = 1.0 / vec2(textureSize(tex, 0));
       for (float i= -1.; i <= 1.; i++)
         for (float j= -1.; j <= 1.; j++)
             {
-              vec4 n = texture(tex, vec2 (uv.x + i/imgW, uv.y + j/imgH));
+              vec4 n = texture(tex, vec2 (uv.x + i*texel.x, uv.y + j*texel.y));
               if (n.w > 0. && (n.x > 0. || n.y > 0. || n.z > 0.))
-                c = vec4 (h_color_r, h_color_g, h_color_b, h_color_a);
+                c = highlight;
             }
     }
 	frag_colour = c;//vec4(c.r, c.g, c.b, 0.4 * c.a);
@@ -1,18 +1,20 @@
 #version 320 es
-precision mediump float;
+precision highp float; // mediump can't address single texels in a 2048 wide atlas page
 
-in vec3 vertex_position;
-in vec2 v_uv;
+layout(location = 0) in vec2 vertex_position; // in pixels, origin at the top left of the screen
+layout(location = 1) in vec2 v_uv;
+layout(location = 2) in vec4 v_highlight;
 out vec2 uv;
-uniform float width;
-uniform float height;
-uniform float imgW;
-uniform float imgH;
-uniform float offsetX;
-uniform float offsetY;
+out vec4 highlight;
+// only changes when the window is resized, see SpriteBatch
+layout(std140) uniform Viewport
+{
+    vec2 viewportSize;
+};
 void main() {
     uv = v_uv;
-    gl_Position = vec4((vec2(vertex_position.x*imgW + offsetX, vertex_position.y*imgH + offsetY) / vec2(width, height)) * 2.0, 0.0, 1.0);
+    highlight = v_highlight;
+    gl_Position = vec4((vertex_position / viewportSize) * 2.0, 0.0, 1.0);
     gl_Position.x = gl_Position.x - 1.0;
     gl_Position.y = 1.0 - gl_Position.y;
 }
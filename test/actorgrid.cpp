@@ -0,0 +1,214 @@
+#include "../apps/freeablo/faworld/actorgrid.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using FAWorld::Actor;
+using FAWorld::ActorGrid;
+
+// The grid never dereferences the actors, so any distinct addresses will do
+static Actor* fakeActor(size_t i)
+{
+    static char storage[4096];
+    return reinterpret_cast<Actor*>(&storage[i]);
+}
+
+static std::vector<Actor*> actorsAt(const ActorGrid& grid, int32_t x, int32_t y)
+{
+    std::vector<Actor*> actors;
+    grid.forEachAt(x, y, [&actors](Actor* actor) {
+        actors.push_back(actor);
+        return false;
+    });
+    std::sort(actors.begin(), actors.end());
+    return actors;
+}
+
+TEST(ActorGrid, AddMoveRemove)
+{
+    ActorGrid grid(10, 10);
+    Actor* a = fakeActor(0);
+
+    ActorGrid::Handle handle = grid.add(a, {2, 3}, {2, 3}, true);
+    ASSERT_NE(ActorGrid::NO_HANDLE, handle);
+    ASSERT_EQ(std::vector<Actor*>{a}, actorsAt(grid, 2, 3));
+    ASSERT_EQ(1u, grid.size());
+
+    // standing still costs nothing
+    ASSERT_FALSE(grid.move(handle, {2, 3}, {2, 3}, true));
+
+    // walking between two tiles, it's on both
+    ASSERT_TRUE(grid.move(handle, {2, 3}, {3, 3}, true));
+    ASSERT_EQ(std::vector<Actor*>{a}, actorsAt(grid, 2, 3));
+    ASSERT_EQ(std::vector<Actor*>{a}, actorsAt(grid, 3, 3));
+
+    ASSERT_TRUE(grid.move(handle, {3, 3}, {3, 3}, true));
+    ASSERT_TRUE(actorsAt(grid, 2, 3).empty());
+    ASSERT_EQ(std::vector<Actor*>{a}, actorsAt(grid, 3, 3));
+
+    grid.remove(handle);
+    ASSERT_TRUE(actorsAt(grid, 3, 3).empty());
+    ASSERT_EQ(0u, grid.size());
+
+    // handles are reused
+    ASSERT_EQ(handle, grid.add(a, {0, 0}, {0, 0}, true));
+}
+
+TEST(ActorGrid, SharedTiles)
+{
+    ActorGrid grid(10, 10);
+    Actor* a = fakeActor(0);
+    Actor* b = fakeActor(1);
+    Actor* c = fakeActor(2);
+
+    ActorGrid::Handle handleA = grid.add(a, {5, 5}, {5, 5}, true);
+    ActorGrid::Handle handleB = grid.add(b, {4, 5}, {5, 5}, true);
+    grid.add(c, {5, 5}, {5, 6}, true);
+
+    ASSERT_EQ((std::vector<Actor*>{a, b, c}), actorsAt(grid, 5, 5));
+
+    // leaving a shared tile doesn't take the others with it, whichever order they were added in
+    grid.move(handleB, {4, 5}, {4, 5}, true);
+    ASSERT_EQ((std::vector<Actor*>{a, c}), actorsAt(grid, 5, 5));
+    grid.remove(handleA);
+    ASSERT_EQ(std::vector<Actor*>{c}, actorsAt(grid, 5, 5));
+    ASSERT_EQ(std::vector<Actor*>{c}, actorsAt(grid, 5, 6));
+    ASSERT_EQ(std::vector<Actor*>{b}, actorsAt(grid, 4, 5));
+}
+
+TEST(ActorGrid, Blocking)
+{
+    ActorGrid grid(10, 10);
+
+    ActorGrid::Handle living = grid.add(fakeActor(0), {2, 2}, {3, 2}, true);
+    ActorGrid::Handle dead = grid.add(fakeActor(1), {3, 2}, {3, 2}, false);
+    ASSERT_TRUE(grid.isBlocked(2, 2));
+    ASSERT_TRUE(grid.isBlocked(3, 2));
+
+    // dying changes nothing but whether it blocks
+    ASSERT_TRUE(grid.move(living, {2, 2}, {3, 2}, false));
+    ASSERT_FALSE(grid.isBlocked(2, 2));
+    ASSERT_FALSE(grid.isBlocked(3, 2));
+    ASSERT_EQ((std::vector<Actor*>{fakeActor(0), fakeActor(1)}), actorsAt(grid, 3, 2));
+
+    ASSERT_TRUE(grid.move(dead, {3, 2}, {3, 2}, true));
+    ASSERT_TRUE(grid.isBlocked(3, 2));
+    grid.remove(dead);
+    ASSERT_FALSE(grid.isBlocked(3, 2));
+
+    ASSERT_FALSE(grid.isBlocked(-1, 0));
+    ASSERT_FALSE(grid.isBlocked(10, 0));
+}
+
+TEST(ActorGrid, OutOfBounds)
+{
+    ActorGrid grid(10, 10);
+    Actor* a = fakeActor(0);
+
+    ActorGrid::Handle handle = grid.add(a, {9, 9}, {10, 10}, true);
+    ASSERT_EQ(std::vector<Actor*>{a}, actorsAt(grid, 9, 9));
+    ASSERT_TRUE(actorsAt(grid, 10, 10).empty());
+    ASSERT_TRUE(actorsAt(grid, -1, 0).empty());
+
+    grid.move(handle, {-1, -1}, {-1, -1}, true);
+    ASSERT_TRUE(actorsAt(grid, 9, 9).empty());
+    grid.remove(handle);
+}
+
+TEST(ActorGrid, Radius)
+{
+    ActorGrid grid(20, 20);
+    grid.add(fakeActor(0), {10, 10}, {10, 10}, true);
+    grid.add(fakeActor(1), {13, 14}, {13, 14}, true); // distance 5
+    grid.add(fakeActor(2), {14, 14}, {15, 15}, true); // distance sqrt(32), walking away
+    grid.add(fakeActor(3), {6, 10}, {5, 10}, true);   // distance 4, walking away
+    grid.add(fakeActor(4), {0, 0}, {0, 0}, true);
+
+    std::vector<Actor*> actors;
+    grid.getActorsInRadius({10, 10}, 5, actors);
+    std::sort(actors.begin(), actors.end());
+
+    // actors on two tiles are only counted once, by their current tile
+    ASSERT_EQ((std::vector<Actor*>{fakeActor(0), fakeActor(1), fakeActor(3)}), actors);
+
+    actors.clear();
+    grid.getActorsInRadius({0, 0}, 0, actors);
+    ASSERT_EQ(std::vector<Actor*>{fakeActor(4)}, actors);
+}
+
+TEST(ActorGrid, Rect)
+{
+    ActorGrid grid(20, 20);
+    grid.add(fakeActor(0), {5, 5}, {5, 5}, true);
+    grid.add(fakeActor(1), {8, 7}, {9, 7}, true); // walking out of the rectangle
+    grid.add(fakeActor(2), {9, 6}, {8, 6}, true); // walking into it
+    grid.add(fakeActor(3), {4, 5}, {4, 5}, true);
+    grid.add(fakeActor(4), {0, 0}, {0, 0}, true);
+
+    std::vector<Actor*> actors;
+    grid.getActorsInRect({5, 5}, {8, 7}, actors);
+    std::sort(actors.begin(), actors.end());
+
+    // only by their current tile, and only once
+    ASSERT_EQ((std::vector<Actor*>{fakeActor(0), fakeActor(1)}), actors);
+
+    // clipped to the grid
+    actors.clear();
+    grid.getActorsInRect({-5, -5}, {100, 0}, actors);
+    ASSERT_EQ(std::vector<Actor*>{fakeActor(4)}, actors);
+}
+
+TEST(ActorGrid, MatchesBruteForce)
+{
+    const int32_t size = 30;
+    const size_t actorCount = 500;
+
+    ActorGrid grid(size, size);
+    std::vector<ActorGrid::Handle> handles;
+    std::vector<std::pair<ActorGrid::Tile, ActorGrid::Tile>> tiles;
+    std::vector<bool> blocking(actorCount, true);
+
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int32_t> coord(0, size - 1);
+    std::uniform_int_distribution<int32_t> step(-1, 1);
+
+    for (size_t i = 0; i < actorCount; i++)
+    {
+        ActorGrid::Tile tile(coord(rng), coord(rng));
+        tiles.push_back({tile, tile});
+        handles.push_back(grid.add(fakeActor(i), tile, tile, true));
+    }
+
+    for (int32_t round = 0; round < 50; round++)
+    {
+        for (size_t i = 0; i < actorCount; i++)
+        {
+            ActorGrid::Tile current = tiles[i].second;
+            ActorGrid::Tile next(std::min(std::max(current.first + step(rng), 0), size - 1), std::min(std::max(current.second + step(rng), 0), size - 1));
+            tiles[i] = {current, next};
+            blocking[i] = rng() % 4 != 0;
+            grid.move(handles[i], current, next, blocking[i]);
+        }
+
+        for (int32_t y = 0; y < size; y++)
+        {
+            for (int32_t x = 0; x < size; x++)
+            {
+                std::vector<Actor*> expected;
+                bool expectedBlocked = false;
+                for (size_t i = 0; i < actorCount; i++)
+                {
+                    if (tiles[i].first == ActorGrid::Tile(x, y) || tiles[i].second == ActorGrid::Tile(x, y))
+                    {
+                        expected.push_back(fakeActor(i));
+                        expectedBlocked = expectedBlocked || blocking[i];
+                    }
+                }
+
+                ASSERT_EQ(expected, actorsAt(grid, x, y));
+                ASSERT_EQ(expectedBlocked, grid.isBlocked(x, y));
+            }
+        }
+    }
+}
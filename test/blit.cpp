@@ -0,0 +1,177 @@
+#include <SDL.h>
+#include <cel/pal.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <render/blit.h>
+#include <vector>
+
+// The per pixel versions below are what the sprite loading code did before the blit kernels, they're kept here as a
+// reference for the results and the timings.
+
+SDL_Surface* createSurface(int32_t width, int32_t height)
+{
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    SDL_Surface* s = SDL_CreateRGBSurface(0, width, height, 32, 0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF);
+#else
+    SDL_Surface* s = SDL_CreateRGBSurface(0, width, height, 32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000);
+#endif
+    SDL_FillRect(s, NULL, SDL_MapRGBA(s->format, 0, 0, 0, 0));
+    return s;
+}
+
+Render::ImageView imageView(SDL_Surface* s) { return Render::ImageView{static_cast<uint8_t*>(s->pixels), s->w, s->h, s->pitch}; }
+
+void setpixel(SDL_Surface* s, int x, int y, Cel::Colour c)
+{
+    Uint32 pixel = SDL_MapRGBA(s->format, c.r, c.g, c.b, ((int)c.visible) * 255);
+    *(Uint32*)((Uint8*)s->pixels + y * s->pitch + x * s->format->BytesPerPixel) = pixel;
+}
+
+Cel::Colour getPixel(SDL_Surface* s, int x, int y)
+{
+    Uint32 pixel = *(Uint32*)((Uint8*)s->pixels + y * s->pitch + x * s->format->BytesPerPixel);
+    Uint8 r, g, b, a;
+    SDL_GetRGBA(pixel, s->format, &r, &g, &b, &a);
+    return Cel::Colour(r, g, b, a == 255);
+}
+
+std::vector<Cel::Colour> randomColours(int32_t count)
+{
+    std::vector<Cel::Colour> retval(count);
+    for (auto& c : retval)
+        c = Cel::Colour(rand(), rand(), rand(), rand() % 3 != 0);
+    return retval;
+}
+
+void fillRandom(SDL_Surface* s)
+{
+    for (int32_t y = 0; y < s->h; y++)
+        for (int32_t x = 0; x < s->w; x++)
+            setpixel(s, x, y, Cel::Colour(rand(), rand(), rand(), rand() % 3 != 0));
+}
+
+bool sameSurface(SDL_Surface* a, SDL_Surface* b)
+{
+    for (int32_t y = 0; y < a->h; y++)
+    {
+        if (memcmp((Uint8*)a->pixels + y * a->pitch, (Uint8*)b->pixels + y * b->pitch, a->w * 4) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+template <typename Func> int64_t timeMicroseconds(Func func)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+TEST(Blit, ColoursMasked)
+{
+    const int32_t frameW = 96, frameH = 96, iterations = 200;
+    std::vector<Cel::Colour> frame = randomColours(frameW * frameH);
+
+    SDL_Surface* expected = createSurface(frameW * 2, frameH);
+    SDL_Surface* actual = createSurface(frameW * 2, frameH);
+
+    // Partly off the right and top edges, to cover clipping too
+    int32_t destX = frameW + frameW / 2;
+    int32_t destY = -10;
+
+    int64_t perPixel = timeMicroseconds([&] {
+        for (int32_t i = 0; i < iterations; i++)
+        {
+            for (int32_t x = 0; x < frameW; x++)
+            {
+                for (int32_t y = 0; y < frameH; y++)
+                {
+                    const Cel::Colour& c = frame[x + y * frameW];
+                    if (c.visible && destX + x < expected->w && destY + y >= 0)
+                        setpixel(expected, destX + x, destY + y, c);
+                }
+            }
+        }
+    });
+
+    int64_t kernel = timeMicroseconds([&] {
+        for (int32_t i = 0; i < iterations; i++)
+            Render::blitColoursMasked(imageView(actual), destX, destY, frame.data(), frameW, frameH);
+    });
+
+    std::cout << "BENCHMARK_BLIT coloursMasked: per pixel " << perPixel << "us, kernel " << kernel << "us" << std::endl;
+    EXPECT_TRUE(sameSurface(expected, actual));
+
+    SDL_FreeSurface(expected);
+    SDL_FreeSurface(actual);
+}
+
+TEST(Blit, Copy)
+{
+    const int32_t iterations = 200;
+
+    SDL_Surface* src = createSurface(256, 256);
+    fillRandom(src);
+
+    SDL_Surface* expected = createSurface(200, 300);
+    SDL_Surface* actual = createSurface(200, 300);
+
+    int64_t perPixel = timeMicroseconds([&] {
+        for (int32_t i = 0; i < iterations; i++)
+        {
+            for (int32_t x = 0; x < 100; x++)
+                for (int32_t y = 0; y < 256; y++)
+                    setpixel(expected, 150 + x - 100, y + 20, getPixel(src, x + 50, y));
+        }
+    });
+
+    int64_t kernel = timeMicroseconds([&] {
+        for (int32_t i = 0; i < iterations; i++)
+            Render::blitCopy(imageView(actual), 50, 20, imageView(src), 50, 0, 100, 256);
+    });
+
+    std::cout << "BENCHMARK_BLIT copy: per pixel " << perPixel << "us, kernel " << kernel << "us" << std::endl;
+    EXPECT_TRUE(sameSurface(expected, actual));
+
+    // Nothing should be written outside the destination
+    Render::blitCopy(imageView(actual), 190, 290, imageView(src), 0, 0, 256, 256);
+    Render::blitCopy(imageView(actual), -300, 0, imageView(src), 0, 0, 256, 256);
+    for (int32_t y = 290; y < 300; y++)
+        for (int32_t x = 190; x < 200; x++)
+            setpixel(expected, x, y, getPixel(src, x - 190, y - 290));
+    EXPECT_TRUE(sameSurface(expected, actual));
+
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(expected);
+    SDL_FreeSurface(actual);
+}
+
+TEST(Blit, ColourKey)
+{
+    SDL_Surface* src = createSurface(128, 128);
+    fillRandom(src);
+
+    for (int32_t i = 0; i < 1000; i++)
+        setpixel(src, rand() % 128, rand() % 128, Cel::Colour(255, 0, 255, true));
+
+    SDL_Surface* expected = createSurface(128, 128);
+    for (int32_t y = 0; y < src->h; y++)
+    {
+        for (int32_t x = 0; x < src->w; x++)
+        {
+            Cel::Colour px = getPixel(src, x, y);
+            if (!(px.r == 255 && px.g == 0 && px.b == 255))
+                setpixel(expected, x, y, px);
+        }
+    }
+
+    Render::applyColourKey(imageView(src), 255, 0, 255);
+    EXPECT_TRUE(sameSurface(expected, src));
+
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(expected);
+}
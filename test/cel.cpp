@@ -2,6 +2,7 @@
 #include <SDL_image.h>
 #include <boost/filesystem.hpp>
 #include <boost/range.hpp>
+#include <chrono>
 #include <faio/fafileobject.h>
 #include <fstream>
 #include <gtest/gtest.h>
@@ -13,6 +14,7 @@
 
 #define private public
 #include <cel/celfile.h>
+#include <cel/framewriter.h>
 
 std::string hashImageData(int32_t width, int32_t height, Cel::Colour* data)
 {
@@ -34,7 +36,22 @@ std::string hashImageData(int32_t width, int32_t height, Cel::Colour* data)
     return s.str();
 }
 
-std::string hashCelFrame(Cel::CelFrame& frame) { return hashImageData(frame.mWidth, frame.mHeight, &frame.mRawImage[0]); }
+std::string hashCelFrame(Cel::CelFrame& frame)
+{
+    if (!frame.isIndexed())
+        return hashImageData(frame.mWidth, frame.mHeight, &frame.mRawImage[0]);
+
+    // The saved hashes are of the bottom up RGBA layout, so expand indexed frames into that first
+    std::vector<Cel::Colour> data(frame.mWidth * frame.mHeight);
+
+    for (int32_t y = 0; y < frame.mHeight; y++)
+    {
+        for (int32_t x = 0; x < frame.mWidth; x++)
+            data[x + ((frame.mHeight - 1 - y) * frame.mWidth)] = frame[x][y];
+    }
+
+    return hashImageData(frame.mWidth, frame.mHeight, &data[0]);
+}
 
 std::vector<std::string> getCelsFromListfile(const std::string& path)
 {
@@ -240,7 +257,19 @@ std::map<std::string, std::vector<std::string>> getCelHashes()
     return retval;
 }
 
-TEST(Cel, TestOpen)
+bool isBrokenCel(const std::string& p)
+{
+    if (Misc::StringUtils::endsWith(p, "unravw.cel")) // this cel file is broken, see https://github.com/mewrnd/blizzconv/issues/2#issuecomment-58065868
+        return true;
+
+    if (p == "monsters\\darkmage\\dmagew.cl2") // this cl2 file is completely broken, but probably just meant to be transparent, see
+                                               // https://github.com/mewrnd/blizzconv/issues/4#issuecomment-201929273
+        return true;
+
+    return false;
+}
+
+void testOpen(Cel::FrameFormat format)
 {
     std::string thisFolder = bfs::path(__FILE__).parent_path().string();
 
@@ -253,14 +282,10 @@ TEST(Cel, TestOpen)
 
     for (auto p : celPaths)
     {
-        if (Misc::StringUtils::endsWith(p, "unravw.cel")) // this cel file is broken, see https://github.com/mewrnd/blizzconv/issues/2#issuecomment-58065868
-            continue;
-
-        if (p == "monsters\\darkmage\\dmagew.cl2") // this cl2 file is completely broken, but probably just meant to be transparent, see
-                                                   // https://github.com/mewrnd/blizzconv/issues/4#issuecomment-201929273
+        if (isBrokenCel(p))
             continue;
 
-        Cel::CelFile cel(p);
+        Cel::CelFile cel(p, format);
 
         bool fileSucceeded = true;
         totalFrames += cel.numFrames();
@@ -301,6 +326,64 @@ TEST(Cel, TestOpen)
     ASSERT_EQ(succeededFrames, totalFrames);
 }
 
+TEST(Cel, TestOpen) { testOpen(Cel::FrameFormat::Rgba); }
+
+TEST(Cel, TestOpenIndexed) { testOpen(Cel::FrameFormat::Indexed); }
+
+// Times decoding every frame with each set of RGBA kernels, Simd::None being the plain per pixel loops.
+// Reading the files is left out of the timings, and every frame is still checked against the saved hashes.
+TEST(Cel, BenchmarkSimd)
+{
+    std::string thisFolder = bfs::path(__FILE__).parent_path().string();
+
+    std::vector<std::string> celPaths = getCelsFromListfile(thisFolder + "/Diablo I.txt");
+    auto celHashes = getCelHashes();
+
+    std::vector<std::pair<Cel::FrameWriter::Simd, std::string>> levels = {
+        {Cel::FrameWriter::Simd::None, "scalar"}, {Cel::FrameWriter::Simd::Sse2, "sse2"}, {Cel::FrameWriter::Simd::Avx2, "avx2"}};
+
+    for (const auto& level : levels)
+    {
+        if (level.first > Cel::FrameWriter::bestSimd())
+            continue;
+
+        Cel::FrameWriter::setSimd(level.first);
+
+        std::chrono::nanoseconds timeByType[2] = {};
+        int32_t framesByType[2] = {};
+        int32_t failedFrames = 0;
+
+        for (auto p : celPaths)
+        {
+            if (isBrokenCel(p) || celHashes[p].size() == 0)
+                continue;
+
+            Cel::CelFile cel(p);
+            int32_t type = Misc::StringUtils::ciEndsWith(p, ".cl2") ? 1 : 0;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int32_t i = 0; i < cel.numFrames(); i++)
+                cel[i];
+            timeByType[type] += std::chrono::high_resolution_clock::now() - start;
+            framesByType[type] += cel.numFrames();
+
+            for (int32_t i = 0; i < cel.numFrames(); i++)
+            {
+                if (celHashes[p][i] != hashCelFrame(cel[i]))
+                    failedFrames++;
+            }
+        }
+
+        std::cout << "BENCHMARK_CEL " << level.second << ": cel " << framesByType[0] << " frames in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(timeByType[0]).count() << "ms, cl2 " << framesByType[1] << " frames in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(timeByType[1]).count() << "ms" << std::endl;
+
+        EXPECT_EQ(failedFrames, 0);
+    }
+
+    Cel::FrameWriter::setSimd(Cel::FrameWriter::bestSimd());
+}
+
 int main(int argc, char** argv)
 {
     FAIO::init();
@@ -0,0 +1,295 @@
+#include "../apps/freeablo/faworld/findpath.h"
+#include "../apps/freeablo/faworld/gamelevel.h"
+#include <gtest/gtest.h>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+using FAWorld::PathAlgorithm;
+using FAWorld::PathFinder;
+typedef PathFinder::Location Location;
+
+class GridLevel : public FAWorld::GameLevelImpl
+{
+public:
+    GridLevel(std::vector<std::string> rows) : mRows(std::move(rows)) {}
+
+    int32_t width() const { return int32_t(mRows[0].size()); }
+    int32_t height() const { return int32_t(mRows.size()); }
+    bool isPassable(int x, int y) const { return x >= 0 && x < width() && y >= 0 && y < height() && mRows[y][x] != '#'; }
+
+    std::vector<std::string> mRows;
+};
+
+static void checkPath(const GridLevel& level, Location start, Location goal, const std::vector<Location>& path)
+{
+    ASSERT_FALSE(path.empty());
+    ASSERT_EQ(goal, path.back());
+
+    Location previous = start;
+    for (const Location& step : path)
+    {
+        ASSERT_LE(std::abs(step.first - previous.first), 1);
+        ASSERT_LE(std::abs(step.second - previous.second), 1);
+        ASSERT_NE(previous, step);
+        ASSERT_TRUE(level.isPassable(step.first, step.second));
+        previous = step;
+    }
+}
+
+TEST(FindPath, AroundWall)
+{
+    GridLevel level({"..........",
+                     ".....#....",
+                     ".....#....",
+                     ".....#....",
+                     ".....#....",
+                     ".........."});
+
+    PathFinder pathFinder;
+    std::vector<Location> path;
+    Location goal(8, 2);
+    bool arrivable = false;
+
+    pathFinder.find(&level, {2, 2}, goal, arrivable, false, path);
+    ASSERT_TRUE(arrivable);
+    checkPath(level, {2, 2}, {8, 2}, path);
+}
+
+TEST(FindPath, Unreachable)
+{
+    GridLevel level({"....#...",
+                     "....#...",
+                     "....#...",
+                     "....#..."});
+
+    PathFinder pathFinder;
+    std::vector<Location> path = {{1, 1}};
+    Location goal(6, 1);
+    bool arrivable = true;
+
+    pathFinder.find(&level, {1, 1}, goal, arrivable, false, path);
+    ASSERT_FALSE(arrivable);
+    ASSERT_TRUE(path.empty());
+}
+
+TEST(FindPath, Adjacent)
+{
+    GridLevel level({"......",
+                     "......",
+                     "......"});
+
+    PathFinder pathFinder;
+    std::vector<Location> path;
+    Location goal(5, 1);
+    bool arrivable = false;
+
+    pathFinder.find(&level, {0, 1}, goal, arrivable, true, path);
+    ASSERT_TRUE(arrivable);
+    ASSERT_EQ(1, std::abs(goal.first - 5));
+    checkPath(level, {0, 1}, goal, path);
+
+    // an impassable goal is treated as adjacent too
+    level.mRows[1][5] = '#';
+    goal = Location(5, 1);
+    pathFinder.find(&level, {0, 1}, goal, arrivable, false, path);
+    ASSERT_TRUE(arrivable);
+    ASSERT_NE(Location(5, 1), goal);
+    checkPath(level, {0, 1}, goal, path);
+}
+
+static int32_t octileCost(Location start, const std::vector<Location>& path)
+{
+    int32_t cost = 0;
+    for (const Location& step : path)
+    {
+        cost += (step.first != start.first && step.second != start.second) ? 14 : 10;
+        start = step;
+    }
+    return cost;
+}
+
+/// Shortest octile path cost from start to every tile, -1 where it can't be reached
+static std::vector<int32_t> dijkstra(const GridLevel& level, Location start)
+{
+    std::vector<int32_t> costs(level.width() * level.height(), -1);
+    typedef std::pair<int32_t, Location> Item;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+    open.push({0, start});
+
+    while (!open.empty())
+    {
+        Item item = open.top();
+        open.pop();
+
+        int32_t& cost = costs[item.second.first + item.second.second * level.width()];
+        if (cost != -1)
+            continue;
+        cost = item.first;
+
+        for (int32_t dy = -1; dy <= 1; dy++)
+        {
+            for (int32_t dx = -1; dx <= 1; dx++)
+            {
+                Location next(item.second.first + dx, item.second.second + dy);
+                if ((dx != 0 || dy != 0) && level.isPassable(next.first, next.second))
+                    open.push({item.first + (dx != 0 && dy != 0 ? 14 : 10), next});
+            }
+        }
+    }
+
+    return costs;
+}
+
+TEST(FindPath, JumpPointIsShortest)
+{
+    const int32_t size = 40;
+
+    std::mt19937 rng(2);
+    PathFinder pathFinder;
+    std::vector<Location> path;
+
+    for (int32_t map = 0; map < 20; map++)
+    {
+        std::vector<std::string> rows(size, std::string(size, '.'));
+        for (auto& row : rows)
+            for (auto& tile : row)
+                tile = rng() % 3 == 0 ? '#' : '.';
+        GridLevel level(rows);
+
+        for (int32_t i = 0; i < 20; i++)
+        {
+            Location start(rng() % size, rng() % size);
+            Location goal(rng() % size, rng() % size);
+            if (!level.isPassable(start.first, start.second) || !level.isPassable(goal.first, goal.second))
+                continue;
+
+            int32_t shortest = dijkstra(level, start)[goal.first + goal.second * size];
+
+            bool arrivable = false;
+            Location foundGoal = goal;
+            pathFinder.find(&level, start, foundGoal, arrivable, false, path, PathAlgorithm::JumpPoint);
+
+            ASSERT_EQ(shortest != -1, arrivable);
+            if (arrivable)
+            {
+                ASSERT_EQ(goal, foundGoal);
+                checkPath(level, start, goal, path);
+                ASSERT_EQ(shortest, octileCost(start, path));
+            }
+        }
+    }
+}
+
+TEST(FindPath, JumpPointReachesFurther)
+{
+    // A winding corridor, too long for plain A* to get to the end of before it gives up
+    std::vector<std::string> rows;
+    for (int32_t i = 0; i < 20; i++)
+    {
+        rows.push_back(std::string(50, '.'));
+        rows.push_back(std::string(50, '#'));
+        rows.back()[i % 2 ? 0 : 49] = '.';
+    }
+    rows.push_back(std::string(50, '.'));
+    GridLevel level(rows);
+
+    PathFinder pathFinder;
+    std::vector<Location> path;
+    bool arrivable = false;
+
+    Location goal(49, 40);
+    pathFinder.find(&level, {0, 0}, goal, arrivable, false, path, PathAlgorithm::AStar);
+    ASSERT_FALSE(arrivable);
+
+    goal = Location(49, 40);
+    pathFinder.find(&level, {0, 0}, goal, arrivable, false, path, PathAlgorithm::JumpPoint);
+    ASSERT_TRUE(arrivable);
+    checkPath(level, {0, 0}, goal, path);
+    ASSERT_LT(pathFinder.expanded(), PathFinder::MAX_EXPANDED);
+    ASSERT_LT(pathFinder.scanned(), PathFinder::MAX_SCANNED);
+
+    // next to the goal works the same way
+    goal = Location(49, 40);
+    pathFinder.find(&level, {0, 0}, goal, arrivable, true, path, PathAlgorithm::JumpPoint);
+    ASSERT_TRUE(arrivable);
+    ASSERT_NE(Location(49, 40), goal);
+    checkPath(level, {0, 0}, goal, path);
+}
+
+TEST(FindPath, JumpPointGivesUp)
+{
+    // An open level with the goal walled off, where each diagonal step scans out to the edges in straight lines
+    std::vector<std::string> rows(200, std::string(200, '.'));
+    for (int32_t i = 0; i < 3; i++)
+    {
+        rows[150][150 + i] = '#';
+        rows[152][150 + i] = '#';
+        rows[150 + i][150] = '#';
+        rows[150 + i][152] = '#';
+    }
+    GridLevel level(rows);
+
+    PathFinder pathFinder;
+    std::vector<Location> path;
+    bool arrivable = true;
+
+    Location goal(151, 151);
+    pathFinder.find(&level, {0, 0}, goal, arrivable, false, path, PathAlgorithm::JumpPoint);
+    ASSERT_FALSE(arrivable);
+    ASSERT_TRUE(path.empty());
+    ASSERT_EQ(PathFinder::MAX_SCANNED, pathFinder.scanned());
+}
+
+TEST(FindPath, ReusedBetweenSearches)
+{
+    const int32_t size = 40;
+
+    std::mt19937 rng(1);
+    std::vector<std::string> rows(size, std::string(size, '.'));
+    for (auto& row : rows)
+        for (auto& tile : row)
+            tile = rng() % 4 == 0 ? '#' : '.';
+
+    GridLevel level(rows);
+    GridLevel small({"....",
+                     "...."});
+
+    // A PathFinder that has done lots of other searches, some on a different level, has to give the same answers as a fresh one
+    PathFinder reused;
+    std::vector<Location> path;
+    std::vector<Location> freshPath;
+
+    for (int32_t i = 0; i < 300; i++)
+    {
+        Location start(rng() % size, rng() % size);
+        Location goal(rng() % size, rng() % size);
+        if (!level.isPassable(start.first, start.second))
+            continue;
+
+        Location reusedGoal = goal;
+        bool reusedArrivable = false;
+        reused.find(&level, start, reusedGoal, reusedArrivable, false, path);
+
+        PathFinder fresh;
+        Location freshGoal = goal;
+        bool freshArrivable = false;
+        fresh.find(&level, start, freshGoal, freshArrivable, false, freshPath);
+
+        ASSERT_EQ(freshArrivable, reusedArrivable);
+        ASSERT_EQ(freshGoal, reusedGoal);
+        ASSERT_EQ(freshPath, path);
+        if (reusedArrivable)
+            checkPath(level, start, reusedGoal, path);
+
+        if (i % 10 == 0)
+        {
+            Location smallGoal(3, 1);
+            bool smallArrivable = false;
+            reused.find(&small, {0, 0}, smallGoal, smallArrivable, false, path);
+            ASSERT_TRUE(smallArrivable);
+            checkPath(small, {0, 0}, {3, 1}, path);
+        }
+    }
+}
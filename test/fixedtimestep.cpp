@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include <misc/fixedtimestep.h>
+
+typedef Misc::FixedTimestep::Clock Clock;
+
+TEST(FixedTimestep, StepsComeDueOnSchedule)
+{
+    Misc::FixedTimestep timestep(125, 10);
+    Clock::time_point start = timestep.nextStepTime();
+
+    ASSERT_EQ(1u, timestep.stepsDue(start));
+    ASSERT_EQ(0u, timestep.stepsDue(start + std::chrono::milliseconds(7)));
+    ASSERT_EQ(1u, timestep.stepsDue(start + std::chrono::milliseconds(8)));
+    ASSERT_EQ(start + std::chrono::milliseconds(16), timestep.nextStepTime());
+
+    // late, so catch up
+    ASSERT_EQ(3u, timestep.stepsDue(start + std::chrono::milliseconds(33)));
+    ASSERT_EQ(start + std::chrono::milliseconds(32), timestep.lastStepTime());
+    ASSERT_EQ(0u, timestep.skippedSteps());
+}
+
+TEST(FixedTimestep, DoesNotDrift)
+{
+    // 1000 / 30 isn't a whole number of milliseconds, but the steps still line up with the seconds
+    Misc::FixedTimestep timestep(30, 1);
+    Clock::time_point start = timestep.nextStepTime();
+
+    for (int32_t i = 0; i < 300; i++)
+        ASSERT_EQ(1u, timestep.stepsDue(timestep.nextStepTime()));
+
+    ASSERT_EQ(start + std::chrono::seconds(10), timestep.nextStepTime());
+}
+
+TEST(FixedTimestep, SkipsPastCatchUpLimit)
+{
+    Misc::FixedTimestep timestep(100, 5);
+    Clock::time_point start = timestep.nextStepTime();
+
+    ASSERT_EQ(1u, timestep.stepsDue(start));
+    ASSERT_EQ(5u, timestep.stepsDue(start + std::chrono::seconds(1)));
+    ASSERT_EQ(95u, timestep.skippedSteps());
+
+    // skipped steps are gone, not owed
+    ASSERT_EQ(start + std::chrono::milliseconds(1010), timestep.nextStepTime());
+    ASSERT_EQ(0u, timestep.stepsDue(start + std::chrono::milliseconds(1005)));
+}
@@ -0,0 +1,141 @@
+#include "../apps/freeablo/faworld/flowfield.h"
+#include <gtest/gtest.h>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+using FAWorld::FlowField;
+typedef FlowField::Tile Tile;
+
+static std::vector<std::string> randomGrid(std::mt19937& rng, int32_t width, int32_t height)
+{
+    std::vector<std::string> rows(height, std::string(width, '.'));
+    for (auto& row : rows)
+        for (auto& tile : row)
+            tile = rng() % 4 == 0 ? '#' : '.';
+    return rows;
+}
+
+static uint8_t bfsDistance(const std::vector<std::string>& rows, Tile from, Tile to)
+{
+    int32_t width = rows[0].size();
+    int32_t height = rows.size();
+
+    std::vector<int32_t> distances(width * height, -1);
+    std::queue<Tile> open;
+    distances[from.first + from.second * width] = 0;
+    open.push(from);
+
+    while (!open.empty())
+    {
+        Tile tile = open.front();
+        open.pop();
+        int32_t distance = distances[tile.first + tile.second * width];
+
+        if (tile == to)
+            return distance <= FlowField::MAX_DISTANCE ? distance : FlowField::UNREACHABLE;
+
+        for (int32_t dy = -1; dy <= 1; dy++)
+        {
+            for (int32_t dx = -1; dx <= 1; dx++)
+            {
+                Tile next(tile.first + dx, tile.second + dy);
+                if (next.first < 0 || next.first >= width || next.second < 0 || next.second >= height || rows[next.second][next.first] == '#' ||
+                    distances[next.first + next.second * width] != -1)
+                    continue;
+
+                distances[next.first + next.second * width] = distance + 1;
+                open.push(next);
+            }
+        }
+    }
+
+    return FlowField::UNREACHABLE;
+}
+
+TEST(FlowField, MatchesBreadthFirstSearch)
+{
+    const int32_t width = 80;
+    const int32_t height = 60;
+
+    std::mt19937 rng(1);
+    std::vector<std::string> rows = randomGrid(rng, width, height);
+    auto isPassable = [&rows](int32_t x, int32_t y) { return rows[y][x] != '#'; };
+
+    FlowField field;
+    for (int32_t i = 0; i < 5; i++)
+    {
+        Tile target;
+        do
+        {
+            target = Tile(rng() % width, rng() % height);
+        } while (!isPassable(target.first, target.second));
+
+        // the same field moved between targets has to match a new one, nothing left over from the last search
+        ASSERT_TRUE(field.update(width, height, target, isPassable));
+        ASSERT_EQ(target, field.target());
+
+        for (int32_t y = 0; y < height; y++)
+        {
+            for (int32_t x = 0; x < width; x++)
+            {
+                if (isPassable(x, y))
+                {
+                    ASSERT_EQ(bfsDistance(rows, target, Tile(x, y)), field.distance(x, y));
+                }
+            }
+        }
+    }
+
+    ASSERT_FALSE(field.update(width, height, field.target(), isPassable));
+    ASSERT_EQ(FlowField::UNREACHABLE, field.distance(-1, 0));
+    ASSERT_EQ(FlowField::UNREACHABLE, field.distance(width, 0));
+}
+
+TEST(FlowField, Limited)
+{
+    std::vector<std::string> rows(1, std::string(FlowField::MAX_DISTANCE + 10, '.'));
+    auto isPassable = [&rows](int32_t x, int32_t y) { return rows[y][x] != '#'; };
+
+    FlowField field;
+    field.update(rows[0].size(), 1, {0, 0}, isPassable);
+
+    ASSERT_EQ(FlowField::MAX_DISTANCE, field.distance(FlowField::MAX_DISTANCE, 0));
+    ASSERT_EQ(FlowField::UNREACHABLE, field.distance(FlowField::MAX_DISTANCE + 1, 0));
+}
+
+TEST(FlowField, NextStep)
+{
+    std::vector<std::string> rows = {"..........",
+                                     "...####...",
+                                     "......#...",
+                                     "......#..."};
+    auto isPassable = [&rows](int32_t x, int32_t y) { return rows[y][x] != '#'; };
+
+    FlowField field;
+    field.update(rows[0].size(), rows.size(), {8, 3}, isPassable);
+
+    // walking down the field from anywhere gets next to the target, one step closer each time
+    Tile tile(0, 3);
+    Tile next;
+    while (field.nextStep(tile, next, isPassable))
+    {
+        ASSERT_EQ(field.distance(tile.first, tile.second) - 1, field.distance(next.first, next.second));
+        ASSERT_LE(std::abs(next.first - tile.first), 1);
+        ASSERT_LE(std::abs(next.second - tile.second), 1);
+        tile = next;
+    }
+    ASSERT_EQ(1, field.distance(tile.first, tile.second));
+
+    // of the tiles as close as each other, it takes the one nearest in a straight line
+    ASSERT_TRUE(field.nextStep({9, 0}, next, isPassable));
+    ASSERT_EQ(Tile(8, 1), next);
+    ASSERT_TRUE(field.nextStep({7, 0}, next, isPassable));
+    ASSERT_EQ(Tile(8, 1), next);
+
+    // and steps round anything in the way, or waits if it can't
+    ASSERT_TRUE(field.nextStep({7, 0}, next, [&isPassable](int32_t x, int32_t y) { return isPassable(x, y) && Tile(x, y) != Tile(8, 1); }));
+    ASSERT_EQ(Tile(7, 1), next);
+    ASSERT_FALSE(field.nextStep({7, 0}, next, [](int32_t, int32_t) { return false; }));
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <render/levelobjects.h>
+#include <vector>
+
+static Render::LevelObject object(int32_t id) { return Render::LevelObject{id, id, 0, 0, 0, 0, -1}; }
+
+static std::vector<int32_t> ids(const Render::LevelObjects& objects, int32_t x, int32_t y)
+{
+    std::vector<int32_t> result;
+    for (const auto& o : objects.objects(x, y))
+        result.push_back(o.spriteCacheIndex);
+    return result;
+}
+
+TEST(LevelObjects, ByTile)
+{
+    Render::LevelObjects objects;
+    objects.resize(20, 20);
+
+    objects.add(5, 5, object(1));
+    objects.add(3, 7, object(2));
+    objects.add(5, 5, object(3));
+    objects.add(10, 2, object(4));
+    objects.add(3, 7, object(5));
+    objects.add(5, 5, object(6));
+
+    // each tile keeps its objects in the order they were added
+    ASSERT_EQ(std::vector<int32_t>({1, 3, 6}), ids(objects, 5, 5));
+    ASSERT_EQ(std::vector<int32_t>({2, 5}), ids(objects, 3, 7));
+    ASSERT_EQ(std::vector<int32_t>({4}), ids(objects, 10, 2));
+
+    // and the rest are empty
+    ASSERT_TRUE(objects.objects(4, 5).empty());
+    ASSERT_TRUE(objects.objects(10, 7).empty());
+    ASSERT_TRUE(objects.objects(0, 0).empty());
+    ASSERT_TRUE(objects.objects(19, 19).empty());
+}
+
+TEST(LevelObjects, Refill)
+{
+    Render::LevelObjects objects;
+    objects.resize(20, 20);
+
+    objects.add(0, 0, object(1));
+    objects.add(19, 19, object(2));
+    objects.add(10, 10, object(3));
+
+    // nothing from the last fill is left behind
+    objects.clear();
+    objects.add(10, 10, object(4));
+
+    ASSERT_TRUE(objects.objects(0, 0).empty());
+    ASSERT_TRUE(objects.objects(19, 19).empty());
+    ASSERT_EQ(std::vector<int32_t>({4}), ids(objects, 10, 10));
+
+    objects.clear();
+    ASSERT_TRUE(objects.objects(10, 10).empty());
+
+    objects.add(10, 10, object(5));
+    objects.resize(20, 20);
+    ASSERT_TRUE(objects.objects(10, 10).empty());
+}
+
+TEST(LevelObjects, HoverColors)
+{
+    Render::LevelObjects objects;
+    objects.resize(20, 20);
+
+    // whatever hoverColorIndex the caller passes in is ignored, add() sets it
+    Render::LevelObject notHighlighted = object(1);
+    notHighlighted.hoverColorIndex = 3;
+
+    objects.add(2, 2, notHighlighted);
+    objects.add(2, 2, object(2), Cel::Colour(255, 0, 0, true));
+    objects.add(8, 1, object(3), Cel::Colour(0, 0, 255, true));
+
+    auto tile = objects.objects(2, 2);
+    ASSERT_EQ(2u, tile.size());
+    ASSERT_FALSE(objects.hoverColor(tile.begin()[0]));
+    ASSERT_TRUE(objects.hoverColor(tile.begin()[1]));
+    ASSERT_EQ(255, objects.hoverColor(tile.begin()[1])->r);
+    ASSERT_EQ(0, objects.hoverColor(tile.begin()[1])->b);
+
+    tile = objects.objects(8, 1);
+    ASSERT_EQ(1u, tile.size());
+    ASSERT_EQ(0, objects.hoverColor(tile.begin()[0])->r);
+    ASSERT_EQ(255, objects.hoverColor(tile.begin()[0])->b);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <misc/triplebuffer.h>
+#include <thread>
+#include <vector>
+
+TEST(TripleBuffer, HandsOverLatest)
+{
+    Misc::TripleBuffer<int32_t> buffer;
+    ASSERT_EQ(nullptr, buffer.latest());
+
+    buffer.back() = 1;
+    buffer.publish();
+    ASSERT_EQ(1, *buffer.latest());
+
+    // nothing new, so the same one again
+    ASSERT_EQ(1, *buffer.latest());
+    ASSERT_EQ(1u, buffer.staleCount());
+
+    // the consumer only ever sees the most recent, the one in between is dropped
+    buffer.back() = 2;
+    buffer.publish();
+    buffer.back() = 3;
+    buffer.publish();
+    ASSERT_EQ(3, *buffer.latest());
+    ASSERT_EQ(1u, buffer.droppedCount());
+    ASSERT_EQ(1u, buffer.staleCount());
+}
+
+TEST(TripleBuffer, ProducerNeverWritesWhatConsumerHolds)
+{
+    Misc::TripleBuffer<int32_t> buffer;
+
+    buffer.back() = 1;
+    buffer.publish();
+    int32_t* held = buffer.latest();
+
+    for (int32_t i = 2; i < 10; i++)
+    {
+        ASSERT_NE(held, &buffer.back());
+        buffer.back() = i;
+        buffer.publish();
+    }
+
+    ASSERT_EQ(1, *held);
+}
+
+struct Snapshot
+{
+    int64_t sequence = 0;
+    std::vector<int64_t> values; ///< all equal to sequence, so a torn write shows up
+};
+
+TEST(TripleBuffer, Threaded)
+{
+    Misc::TripleBuffer<Snapshot> buffer;
+    const int64_t count = 100000;
+
+    std::thread producer([&]() {
+        for (int64_t i = 1; i <= count; i++)
+        {
+            Snapshot& snapshot = buffer.back();
+            snapshot.sequence = i;
+            snapshot.values.assign(16, i);
+            buffer.publish();
+        }
+    });
+
+    int64_t last = 0;
+    while (last != count)
+    {
+        Snapshot* snapshot = buffer.latest();
+        if (!snapshot)
+            continue;
+
+        ASSERT_GE(snapshot->sequence, last);
+        for (int64_t value : snapshot->values)
+            ASSERT_EQ(snapshot->sequence, value);
+
+        last = snapshot->sequence;
+    }
+
+    producer.join();
+}